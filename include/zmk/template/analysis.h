@@ -0,0 +1,57 @@
+/**
+ * Template Feature - Deferred Analysis
+ *
+ * Statistics derived from captured key transitions are computed on a
+ * dedicated low-priority workqueue, fed through its own lock-free ring, so
+ * the capture path only copies the event and wakes the queue.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+
+#include <zmk/template/event_ring.h>
+
+/**
+ * Queue a captured transition for analysis. Never blocks; if the analysis
+ * ring is full the event is left out of the statistics and counted, and
+ * keys whose release was lost are released from the matrix state once the
+ * ring drains.
+ */
+void zmk_template_analysis_submit(const struct zmk_template_key_event *ev);
+
+/**
+ * Queue a raw transition seen by the kscan tap for the shadow debouncers.
+ * Must only be called from the kscan callback. Never blocks.
+ */
+void zmk_template_analysis_submit_raw(uint32_t position, bool pressed);
+
+/**
+ * Queue a burst the kscan tap finished debouncing for the bounce statistics.
+ * Must be called from the context that captures the tap's debounced
+ * transitions. Never blocks.
+ */
+void zmk_template_analysis_submit_burst(uint32_t position, bool pressed,
+                                        uint32_t rejected,
+                                        uint32_t duration_us);
+
+/**
+ * The analysis workqueue, for deferred work that belongs off the keypress
+ * path.
+ */
+struct k_work_q *zmk_template_analysis_queue(void);
+
+/**
+ * Counter bumped by every analysed transition, after the statistics derived
+ * from it are updated. Lets readers of several pages detect changes in
+ * between.
+ */
+uint32_t zmk_template_analysis_generation(void);
+
+/**
+ * Number of transitions left out of the statistics since boot because the
+ * analysis ring was full.
+ */
+uint32_t zmk_template_analysis_dropped(void);
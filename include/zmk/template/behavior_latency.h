@@ -0,0 +1,32 @@
+/**
+ * Template Feature - Behavior Latency
+ *
+ * How long each behavior holds back the output of a keypress: the time from
+ * its own invocation to the first binding it invokes, e.g. the tapping
+ * term of a hold-tap resolved as hold, or the wait for a tap-dance to
+ * settle. Combos are accounted under their own entry.
+ */
+
+#pragma once
+
+#include <zmk/template/latency.h>
+
+// Entry 0 collects bindings invoked by combos, from the combo's key event.
+#define ZMK_TEMPLATE_BEHAVIOR_LATENCY_COMBO 0
+
+struct zmk_template_behavior_latency {
+  // Behavior device name, NULL for unused entries
+  const char *name;
+  struct zmk_template_latency_histogram histogram;
+};
+
+/**
+ * Number of entries, including unused ones.
+ */
+int zmk_template_behavior_latency_count(void);
+
+/**
+ * Entry `index`, or NULL if out of range.
+ */
+const struct zmk_template_behavior_latency *
+zmk_template_behavior_latency_get(int index);
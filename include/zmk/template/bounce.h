@@ -0,0 +1,49 @@
+/**
+ * Template Feature - Debounce Rejection Statistics
+ *
+ * Filled on the analysis workqueue from the bursts the kscan tap queues when
+ * it debounces the raw transitions of the wrapped kscan itself. A burst
+ * starts with a raw transition away from the debounced state and ends once
+ * the raw state held still for the debounce time; every transition of a
+ * burst but the accepted one was rejected.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zmk/template/counter.h>
+#include <zmk/template/matrix.h>
+
+#define ZMK_TEMPLATE_BOUNCE_BUCKETS 12
+
+// Bucket 0 holds bursts shorter than 2^6 us, the last one 2^16 us and up.
+#define ZMK_TEMPLATE_BOUNCE_MIN_SHIFT 6
+
+struct zmk_template_bounce_stats {
+  // Raw transitions rejected, indexed by key position
+  zmk_template_counter_t rejected[ZMK_TEMPLATE_KEY_COUNT];
+  // Bursts with at least one rejected transition
+  zmk_template_counter_t bursts[ZMK_TEMPLATE_KEY_COUNT];
+  // Longest burst of each key in microseconds, saturating
+  uint16_t max_burst_us[ZMK_TEMPLATE_KEY_COUNT];
+  // Burst durations over all keys, of bursts starting with a press and with
+  // a release
+  uint32_t press_histogram[ZMK_TEMPLATE_BOUNCE_BUCKETS];
+  uint32_t release_histogram[ZMK_TEMPLATE_BOUNCE_BUCKETS];
+};
+
+/**
+ * Record a completed burst of a key. `pressed` is the direction of its first
+ * transition and `duration_us` the time from its first to its last
+ * transition. Bursts without rejected transitions are ignored. Called from
+ * the analysis workqueue.
+ */
+void zmk_template_bounce_record(uint32_t position, bool pressed,
+                                uint32_t rejected, uint32_t duration_us);
+
+/**
+ * Live view of the bounce statistics.
+ */
+const struct zmk_template_bounce_stats *zmk_template_bounce_get(void);
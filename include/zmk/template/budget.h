@@ -0,0 +1,54 @@
+/**
+ * Template Feature - Overhead Budget
+ *
+ * The module measures the cycles it spends on key events and steps down to
+ * cheaper modes when that exceeds a share of the CPU configured in Kconfig,
+ * so diagnostics never become the reason a keypress is late. It steps back
+ * up once the load stayed well below the budget for a while.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum zmk_template_budget_mode {
+  // Every event is captured and analysed
+  ZMK_TEMPLATE_BUDGET_FULL,
+  // Only 1 in CONFIG_ZMK_TEMPLATE_FEATURE_BUDGET_SAMPLE_EVERY events enters
+  // the capture ring and the hold time estimates
+  ZMK_TEMPLATE_BUDGET_SAMPLED,
+  // Only counters, the per-key state of stuck key and ghost detection and
+  // the trigger; chatter is not detected, so chatter triggers do not fire
+  ZMK_TEMPLATE_BUDGET_COUNTERS,
+};
+
+struct zmk_template_budget_stats {
+  enum zmk_template_budget_mode mode;
+  // Share of the CPU spent by the module in the last complete window, in
+  // parts per million
+  uint32_t overhead_ppm;
+  // Events measured and their cost since boot
+  uint32_t events;
+  uint64_t event_total_ns;
+  uint32_t event_max_ns;
+  // Number of times the mode stepped down
+  uint32_t step_downs;
+};
+
+/**
+ * Add `cycles` of zmk_template_cycles_now() time to the running figure.
+ * `event` marks the cost of handling one key event, as opposed to batched
+ * work such as stream flushes. Safe from any context.
+ */
+void zmk_template_budget_account(uint32_t cycles, bool event);
+
+/**
+ * Current mode.
+ */
+enum zmk_template_budget_mode zmk_template_budget_mode(void);
+
+/**
+ * Copy the current figures.
+ */
+void zmk_template_budget_get(struct zmk_template_budget_stats *stats);
@@ -0,0 +1,57 @@
+/**
+ * Template Feature - Key Event Capture
+ *
+ * Entry point for every key scan transition seen by the module, and the
+ * consumer side of the capture ring read by the RPC handler.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zmk/template/event_ring.h>
+
+/**
+ * Record a key transition. Timestamps it with the hardware cycle counter,
+ * appends it to the capture ring and queues it for analysis. Never blocks or
+ * allocates, so it is safe to call from the kscan callback path.
+ */
+void zmk_template_capture_key_event(uint32_t position, bool pressed);
+
+/**
+ * Drain up to `max` captured events into `out`, oldest first.
+ * Must only be called from a single consumer context.
+ */
+size_t zmk_template_capture_read(struct zmk_template_key_event *out,
+                                 size_t max);
+
+/**
+ * Copy the captured event `index` places after the oldest unread one without
+ * consuming it. Same consumer rules as zmk_template_capture_read().
+ */
+bool zmk_template_capture_peek(size_t index,
+                               struct zmk_template_key_event *out);
+
+/**
+ * Consume up to `count` of the oldest captured events.
+ */
+void zmk_template_capture_consume(size_t count);
+
+/**
+ * Number of captured events waiting to be read.
+ */
+size_t zmk_template_capture_pending(void);
+
+/**
+ * Number of events dropped because the capture ring was full since the last
+ * call.
+ */
+uint32_t zmk_template_capture_take_dropped(void);
+
+/**
+ * Number of events kept out of the capture ring by the CPU budget since the
+ * last call.
+ */
+uint32_t zmk_template_capture_take_sampled_out(void);
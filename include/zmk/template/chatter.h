@@ -0,0 +1,40 @@
+/**
+ * Template Feature - Chatter Detection
+ *
+ * Flags press→release→press sequences of the same key that happen faster
+ * than a human can type, and keeps a log2 histogram of those re-trigger
+ * intervals per key.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zmk/template/counter.h>
+#include <zmk/template/matrix.h>
+
+#define ZMK_TEMPLATE_CHATTER_BUCKETS                                           \
+  CONFIG_ZMK_TEMPLATE_FEATURE_CHATTER_HISTOGRAM_BUCKETS
+
+// Bucket 0 holds re-triggers faster than 2^8 us.
+#define ZMK_TEMPLATE_CHATTER_MIN_SHIFT 8
+
+struct zmk_template_chatter_stats {
+  uint32_t total;
+  // Re-trigger interval histograms indexed by key position
+  zmk_template_counter_t histogram[ZMK_TEMPLATE_KEY_COUNT]
+                                  [ZMK_TEMPLATE_CHATTER_BUCKETS];
+};
+
+/**
+ * Feed a key transition captured at the given cycle counter timestamp.
+ * Returns true if the press was classified as chatter. O(1).
+ */
+bool zmk_template_chatter_record(uint32_t position, bool pressed,
+                                 uint32_t timestamp);
+
+/**
+ * Live view of the chatter statistics.
+ */
+const struct zmk_template_chatter_stats *zmk_template_chatter_get(void);
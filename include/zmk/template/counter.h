@@ -0,0 +1,69 @@
+/**
+ * Template Feature - Tiered Counters
+ *
+ * Compact event counters for per-key statistics. Each counter is a narrow
+ * hot value plus the index of its overflow slot; when it wraps, the carry is
+ * kept in a small pool of slots shared by all counters, so reads still
+ * return exact totals while only the few busy counters pay for full width.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <zephyr/toolchain.h>
+
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_COUNTER_WIDTH_32)
+
+typedef uint32_t zmk_template_counter_t;
+
+#else
+
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_COUNTER_WIDTH_8)
+typedef uint8_t zmk_template_counter_hot_t;
+#else
+typedef uint16_t zmk_template_counter_hot_t;
+#endif
+
+typedef struct __packed {
+  zmk_template_counter_hot_t value;
+  // 1-based overflow slot taken on the first wrap, 0 while there is none
+  uint8_t slot;
+} zmk_template_counter_t;
+
+#define ZMK_TEMPLATE_COUNTER_MAX ((zmk_template_counter_hot_t)-1)
+
+#endif
+
+/**
+ * Carry path of zmk_template_counter_inc(). Must only be called from the
+ * single context that increments counters.
+ */
+void zmk_template_counter_carry(zmk_template_counter_t *counter);
+
+/**
+ * Increment a counter. Must only be called from the single context that
+ * increments counters; O(1) unless the hot value wraps.
+ */
+static inline void zmk_template_counter_inc(zmk_template_counter_t *counter) {
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_COUNTER_WIDTH_32)
+  (*counter)++;
+#else
+  if (counter->value == ZMK_TEMPLATE_COUNTER_MAX) {
+    zmk_template_counter_carry(counter);
+    return;
+  }
+  counter->value++;
+#endif
+}
+
+/**
+ * Exact value of a counter, unless the overflow slots ran out while it
+ * wrapped; it then saturates, see zmk_template_counter_lost(). O(1).
+ */
+uint32_t zmk_template_counter_read(const zmk_template_counter_t *counter);
+
+/**
+ * Number of increments dropped because the overflow slots ran out.
+ */
+uint32_t zmk_template_counter_lost(void);
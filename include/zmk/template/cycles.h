@@ -0,0 +1,61 @@
+/**
+ * Template Feature - Cycle Counting
+ *
+ * Fine-grained cycle counter used to measure the module's own overhead. Uses
+ * the Zephyr timing functions (e.g. DWT on Cortex-M) when available, since
+ * the system cycle counter may be as coarse as a 32 kHz RTC.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+
+#if IS_ENABLED(CONFIG_TIMING_FUNCTIONS)
+
+#include <zephyr/timing/timing.h>
+
+typedef timing_t zmk_template_cycles_t;
+
+static inline zmk_template_cycles_t zmk_template_cycles_now(void) {
+  return timing_counter_get();
+}
+
+static inline uint32_t zmk_template_cycles_since(zmk_template_cycles_t start) {
+  timing_t end = timing_counter_get();
+
+  return (uint32_t)timing_cycles_get(&start, &end);
+}
+
+static inline uint32_t zmk_template_cycles_between(zmk_template_cycles_t start,
+                                                   zmk_template_cycles_t end) {
+  return (uint32_t)timing_cycles_get(&start, &end);
+}
+
+static inline uint64_t zmk_template_cycles_to_ns(uint64_t cycles) {
+  return timing_cycles_to_ns(cycles);
+}
+
+#else
+
+typedef uint32_t zmk_template_cycles_t;
+
+static inline zmk_template_cycles_t zmk_template_cycles_now(void) {
+  return k_cycle_get_32();
+}
+
+static inline uint32_t zmk_template_cycles_since(zmk_template_cycles_t start) {
+  return k_cycle_get_32() - start;
+}
+
+static inline uint32_t zmk_template_cycles_between(zmk_template_cycles_t start,
+                                                   zmk_template_cycles_t end) {
+  return end - start;
+}
+
+static inline uint64_t zmk_template_cycles_to_ns(uint64_t cycles) {
+  return k_cyc_to_ns_floor64(cycles);
+}
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * Template Feature - Event Dispatch Profile
+ *
+ * Dispatch counts and listener time for every ZMK event type, to find which
+ * behavior or module is slow on the keypress path. The event manager's
+ * dispatch is replaced at link time so each listener call can be timed.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zmk/event_manager.h>
+
+struct zmk_template_event_profile {
+  // Events raised, not counting continuations after a capture is released
+  uint32_t dispatches;
+  // Time spent in listeners, including events they raised themselves
+  uint64_t total_ns;
+  uint32_t max_ns;
+  // Longest single listener call and the listener that made it, NULL until
+  // the first dispatch
+  const struct zmk_listener *slowest_listener;
+  uint32_t slowest_ns;
+};
+
+/**
+ * Number of event types registered with the event manager.
+ */
+int zmk_template_event_profile_count(void);
+
+/**
+ * Name of event type `index`, e.g. "zmk_position_state_changed".
+ */
+const char *zmk_template_event_profile_name(int index);
+
+/**
+ * Copy the profile of event type `index`. Returns false if it is not
+ * profiled.
+ */
+bool zmk_template_event_profile_get(int index,
+                                    struct zmk_template_event_profile *out);
+
+/**
+ * Restart the profiles.
+ */
+void zmk_template_event_profile_reset(void);
@@ -0,0 +1,116 @@
+/**
+ * Template Feature - Key Event Ring
+ *
+ * Lock-free ring buffer used to hand key scan events from the capture path to
+ * the RPC handler.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+
+enum zmk_template_key_event_kind {
+  // A debounced transition of a key position
+  ZMK_TEMPLATE_KEY_EVENT_POSITION,
+  // A raw transition seen by the kscan tap before its debouncing
+  ZMK_TEMPLATE_KEY_EVENT_RAW,
+  // A burst of raw transitions the kscan tap finished debouncing
+  ZMK_TEMPLATE_KEY_EVENT_BURST,
+};
+
+/**
+ * A single key scan transition.
+ *
+ * `timestamp` is taken from the hardware cycle counter (k_cycle_get_32()) at
+ * the moment the transition was captured. Raw transitions carry kernel ticks
+ * instead, and bursts their duration and rejected transitions, see
+ * ZMK_TEMPLATE_BURST_TIMESTAMP(). Only the analysis sees kinds other than
+ * position events.
+ */
+struct zmk_template_key_event {
+  uint32_t timestamp;
+  uint16_t position;
+  bool pressed;
+  uint8_t kind;
+};
+
+// Burst events pack the rejected transitions (saturating at 255) into the
+// top byte of `timestamp` and the duration in microseconds (saturating at
+// about 16 s) into the rest.
+#define ZMK_TEMPLATE_BURST_TIMESTAMP(rejected, duration_us)                    \
+  (((uint32_t)MIN(rejected, UINT8_MAX) << 24) |                               \
+   MIN(duration_us, BIT_MASK(24)))
+#define ZMK_TEMPLATE_BURST_REJECTED(timestamp) ((timestamp) >> 24)
+#define ZMK_TEMPLATE_BURST_DURATION_US(timestamp) ((timestamp) & BIT_MASK(24))
+
+/**
+ * Fixed-size single-producer/single-consumer ring of key events.
+ *
+ * The producer only ever writes `head` and the consumer only ever writes
+ * `tail`, so neither side needs a lock. When the ring is full new events are
+ * dropped and counted instead of overwriting unread ones.
+ */
+struct zmk_template_event_ring {
+  struct zmk_template_key_event *const buf;
+  const uint32_t mask;
+  atomic_t head;
+  atomic_t tail;
+  atomic_t dropped;
+};
+
+#define ZMK_TEMPLATE_EVENT_RING_DEFINE(name, size)                             \
+  BUILD_ASSERT(IS_POWER_OF_TWO(size),                                          \
+               "Event ring size must be a power of two");                      \
+  static struct zmk_template_key_event _CONCAT(name, _buf)[size];              \
+  static struct zmk_template_event_ring name = {                               \
+      .buf = _CONCAT(name, _buf),                                              \
+      .mask = (size) - 1,                                                      \
+  }
+
+/**
+ * Append an event. Must only be called from the single producer context.
+ * Never blocks; returns false if the ring was full and the event was dropped.
+ */
+bool zmk_template_event_ring_put(struct zmk_template_event_ring *ring,
+                                 const struct zmk_template_key_event *ev);
+
+/**
+ * Move up to `max` of the oldest events into `out`. Must only be called from
+ * the single consumer context. Returns the number of events copied.
+ */
+size_t zmk_template_event_ring_get(struct zmk_template_event_ring *ring,
+                                   struct zmk_template_key_event *out,
+                                   size_t max);
+
+/**
+ * Copy the event `index` places after the oldest unread one without consuming
+ * it. Must only be called from the single consumer context. Returns false if
+ * fewer events are waiting.
+ */
+bool zmk_template_event_ring_peek(struct zmk_template_event_ring *ring,
+                                  size_t index,
+                                  struct zmk_template_key_event *out);
+
+/**
+ * Consume up to `count` of the oldest events without copying them. Must only
+ * be called from the single consumer context.
+ */
+void zmk_template_event_ring_skip(struct zmk_template_event_ring *ring,
+                                  size_t count);
+
+/**
+ * Number of events currently waiting to be read.
+ */
+size_t zmk_template_event_ring_size(struct zmk_template_event_ring *ring);
+
+/**
+ * Return the number of events dropped since the last call and reset it.
+ */
+uint32_t zmk_template_event_ring_take_dropped(
+    struct zmk_template_event_ring *ring);
@@ -0,0 +1,22 @@
+/**
+ * Template Feature - Stuck Key Event
+ *
+ * Raised when a key has been held longer than the stuck threshold, and again
+ * when such a key is released.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zmk/event_manager.h>
+
+struct zmk_template_stuck_key_changed {
+  uint32_t position;
+  bool stuck;
+  // How long the key has been (or was) held down
+  uint32_t held_ms;
+};
+
+ZMK_EVENT_DECLARE(zmk_template_stuck_key_changed);
@@ -0,0 +1,54 @@
+/**
+ * Template Feature - Ghost Key Detection
+ *
+ * Flags presses that complete a rectangle of pressed keys in the matrix. On a
+ * matrix without working diodes the fourth corner of such a rectangle reads
+ * as pressed whenever the other three are, so the new key is either a ghost
+ * or, if it was really pressed, one that a diode-less matrix would mask.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zmk/template/matrix.h>
+
+#define ZMK_TEMPLATE_GHOST_HISTORY CONFIG_ZMK_TEMPLATE_FEATURE_GHOST_HISTORY
+
+/**
+ * A suspected ghost press at (row, column), completing the rectangle with the
+ * pressed keys at (other_row, column), (row, other_column) and (other_row,
+ * other_column). Rows and columns are those of the matrix transform.
+ */
+struct zmk_template_ghost_suspect {
+  uint32_t timestamp;
+  uint16_t position;
+  uint8_t row;
+  uint8_t column;
+  uint8_t other_row;
+  uint8_t other_column;
+  // Rectangles completed by this press; only the first one is described
+  uint8_t rectangles;
+};
+
+struct zmk_template_ghost_report {
+  // Suspects since boot
+  uint32_t total;
+  // The n-th suspect is kept in suspects[n % ZMK_TEMPLATE_GHOST_HISTORY]
+  // until it is overwritten
+  struct zmk_template_ghost_suspect suspects[ZMK_TEMPLATE_GHOST_HISTORY];
+};
+
+/**
+ * Feed a key transition captured at the given cycle counter timestamp.
+ * Returns true if the press was flagged. O(rows).
+ */
+bool zmk_template_ghost_record(uint32_t position, bool pressed,
+                               uint32_t timestamp);
+
+/**
+ * Live view of the recent suspects, or NULL when the keyboard has no matrix
+ * transform or one wider than 64 columns.
+ */
+const struct zmk_template_ghost_report *zmk_template_ghost_get(void);
@@ -0,0 +1,52 @@
+/**
+ * Template Feature - HID Report Statistics
+ *
+ * How fast the endpoint emits HID reports, how many key transitions each
+ * report carries and how long handing a report to the transport takes. Set
+ * against the scan rate this shows whether fast rolls and macros are
+ * limited by the scan, the keymap or the endpoint queue.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Reports carrying 0, 1, 2, 3 and 4 or more new key transitions
+#define ZMK_TEMPLATE_HID_MERGED_BUCKETS 5
+
+struct zmk_template_hid_stats {
+  uint32_t reports;
+  // Reports the endpoint failed to queue or send
+  uint32_t send_errors;
+  // Key transitions captured while the statistics ran
+  uint32_t transitions;
+  // Reports in the complete second before the latest report, and the
+  // highest such figure
+  uint32_t reports_per_second;
+  uint32_t peak_reports_per_second;
+  uint32_t merged_histogram[ZMK_TEMPLATE_HID_MERGED_BUCKETS];
+  // Time spent building the report and handing it to the transport
+  uint64_t send_total_ns;
+  uint32_t send_max_ns;
+};
+
+/**
+ * Count a key transition towards the next report. Safe from any context.
+ */
+void zmk_template_hid_stats_transition(void);
+
+/**
+ * Record a report handed to the endpoint, which took `cycles` of
+ * zmk_template_cycles_now() time and returned `ret`.
+ */
+void zmk_template_hid_stats_report(uint32_t cycles, int ret);
+
+/**
+ * Copy the current statistics.
+ */
+void zmk_template_hid_stats_get(struct zmk_template_hid_stats *stats);
+
+/**
+ * Restart the statistics.
+ */
+void zmk_template_hid_stats_reset(void);
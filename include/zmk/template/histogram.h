@@ -0,0 +1,33 @@
+/**
+ * Template Feature - Log2 Histograms
+ *
+ * Integer-only bucketing shared by the histogram based diagnostics. Bucket 0
+ * holds values below 2^min_shift, bucket k holds [2^(min_shift+k-1),
+ * 2^(min_shift+k)) and the last bucket is open ended.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+
+static inline uint8_t zmk_template_log2_bucket(uint32_t value,
+                                               uint8_t min_shift,
+                                               uint8_t buckets) {
+  uint32_t scaled = value >> min_shift;
+
+  if (scaled == 0) {
+    return 0;
+  }
+
+  return MIN(32 - __builtin_clz(scaled), buckets - 1);
+}
+
+/**
+ * Smallest value that falls into the given bucket.
+ */
+static inline uint32_t zmk_template_log2_bucket_floor(uint8_t bucket,
+                                                      uint8_t min_shift) {
+  return bucket == 0 ? 0 : BIT(min_shift + bucket - 1);
+}
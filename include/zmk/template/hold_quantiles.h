@@ -0,0 +1,66 @@
+/**
+ * Template Feature - Hold Duration Quantiles
+ *
+ * Streaming p50/p95/p99 estimates of how long each key is held down per
+ * press, using the extended P² algorithm: nine markers per key track the
+ * quantiles and are nudged towards their ideal positions by piecewise
+ * parabolic interpolation. No samples are stored.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zmk/template/matrix.h>
+
+// Min, max and p50/p95/p99 with a marker between each pair of them
+#define ZMK_TEMPLATE_HOLD_MARKERS 9
+
+// Marker heights are kept in units of this many microseconds and saturate
+// at UINT16_MAX units, i.e. about 6.5 s.
+#define ZMK_TEMPLATE_HOLD_UNIT_US 100
+
+enum zmk_template_hold_quantile {
+  ZMK_TEMPLATE_HOLD_P50,
+  ZMK_TEMPLATE_HOLD_P95,
+  ZMK_TEMPLATE_HOLD_P99,
+  ZMK_TEMPLATE_HOLD_QUANTILE_COUNT,
+};
+
+struct zmk_template_hold_estimator {
+  // Observations so far. Halved together with the marker positions when it
+  // saturates, so old presses gradually weigh less.
+  uint16_t count;
+  // 1-based marker positions in the sorted observations
+  uint16_t positions[ZMK_TEMPLATE_HOLD_MARKERS];
+  // Marker heights, or the sorted first observations while count is below
+  // ZMK_TEMPLATE_HOLD_MARKERS
+  uint16_t heights[ZMK_TEMPLATE_HOLD_MARKERS];
+};
+
+/**
+ * Feed a key transition captured at the given cycle counter timestamp. The
+ * estimate of a key is updated on release. O(1).
+ */
+void zmk_template_hold_quantiles_record(uint32_t position, bool pressed,
+                                        uint32_t timestamp);
+
+/**
+ * Drop the hold in progress of a key whose release was never seen, without
+ * adding a sample.
+ */
+void zmk_template_hold_quantiles_forget(uint32_t position);
+
+/**
+ * Number of observations weighing into the estimates of a key. 0 for keys
+ * never released and out of range positions.
+ */
+uint32_t zmk_template_hold_quantiles_samples(uint32_t position);
+
+/**
+ * Current estimate of a quantile of the hold duration of a key, in
+ * microseconds. Only meaningful if the key has samples.
+ */
+uint32_t zmk_template_hold_quantile_us(uint32_t position,
+                                       enum zmk_template_hold_quantile q);
@@ -0,0 +1,35 @@
+/**
+ * Template Feature - Per-Key Actuation Counters
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zmk/template/counter.h>
+#include <zmk/template/matrix.h>
+
+/**
+ * Press and release counts indexed by key position. Kept as a struct of
+ * arrays so that each column can be dumped with a single linear pass.
+ */
+struct zmk_template_key_counters {
+  zmk_template_counter_t presses[ZMK_TEMPLATE_KEY_COUNT];
+  zmk_template_counter_t releases[ZMK_TEMPLATE_KEY_COUNT];
+  // Capture generation of the last change of each key, for delta sync
+  uint32_t modified[ZMK_TEMPLATE_KEY_COUNT];
+};
+
+/**
+ * Count a transition of the given key position and stamp it with the capture
+ * generation it belongs to. Out of range positions are ignored.
+ */
+void zmk_template_key_counters_record(uint32_t position, bool pressed,
+                                      uint32_t generation);
+
+/**
+ * Live view of the counters. Values may advance while being read; use
+ * zmk_template_counter_read() to get their totals.
+ */
+const struct zmk_template_key_counters *zmk_template_key_counters_get(void);
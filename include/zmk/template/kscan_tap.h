@@ -0,0 +1,25 @@
+/**
+ * Template Feature - Kscan Diagnostics Tap
+ *
+ * Statistics of the `zmk,kscan-diagnostics-tap` shim driver.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+struct zmk_template_kscan_tap_stats {
+  // Transitions forwarded by all tap instances
+  uint32_t events;
+  // Transitions whose row/column has no key in the matrix transform
+  uint32_t unmapped;
+  // Time spent by the tap itself, excluding the forwarded callback
+  uint64_t overhead_total_ns;
+  uint32_t overhead_max_ns;
+};
+
+/**
+ * Sum the statistics of every tap instance.
+ */
+void zmk_template_kscan_tap_get_stats(
+    struct zmk_template_kscan_tap_stats *stats);
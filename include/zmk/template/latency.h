@@ -0,0 +1,63 @@
+/**
+ * Template Feature - Keypress Pipeline Latency
+ *
+ * Timestamps each keypress as it moves from the kscan callback through the
+ * position and keycode events to the HID endpoint, and keeps a log2
+ * histogram of the time spent in every stage.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <zmk/template/cycles.h>
+
+enum zmk_template_latency_stage {
+  // kscan callback to position event, only measured with the kscan tap
+  ZMK_TEMPLATE_LATENCY_STAGE_SCAN,
+  // position event to keycode event, i.e. time spent in behaviors
+  ZMK_TEMPLATE_LATENCY_STAGE_BEHAVIOR,
+  // keycode event to HID report handed to the endpoint
+  ZMK_TEMPLATE_LATENCY_STAGE_ENDPOINT,
+  // earliest timestamp of the keypress to HID report
+  ZMK_TEMPLATE_LATENCY_STAGE_TOTAL,
+  ZMK_TEMPLATE_LATENCY_STAGE_COUNT,
+};
+
+// Bucket 0 holds latencies below 2^4 us, the last bucket anything above ~8 s.
+#define ZMK_TEMPLATE_LATENCY_MIN_SHIFT 4
+#define ZMK_TEMPLATE_LATENCY_BUCKETS 20
+
+struct zmk_template_latency_histogram {
+  uint32_t count;
+  uint32_t max_us;
+  uint32_t buckets[ZMK_TEMPLATE_LATENCY_BUCKETS];
+};
+
+/**
+ * Remember when the kscan callback reported a transition of `position`, as
+ * a zmk_template_cycles_now() timestamp.
+ */
+void zmk_template_latency_kscan(uint32_t position,
+                                zmk_template_cycles_t timestamp);
+
+/**
+ * Mark that a HID report has been handed to the endpoint.
+ */
+void zmk_template_latency_report_sent(void);
+
+/**
+ * Add a sample to a latency histogram.
+ */
+void zmk_template_latency_histogram_add(
+    struct zmk_template_latency_histogram *histogram, uint32_t us);
+
+const struct zmk_template_latency_histogram *
+zmk_template_latency_get(enum zmk_template_latency_stage stage);
+
+/**
+ * Estimate a percentile from the histogram. The result is the upper bound of
+ * the bucket containing it, capped at the observed maximum.
+ */
+uint32_t zmk_template_latency_percentile_us(
+    const struct zmk_template_latency_histogram *histogram, uint8_t percent);
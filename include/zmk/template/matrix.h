@@ -0,0 +1,67 @@
+/**
+ * Template Feature - Matrix Geometry
+ *
+ * Resolves the matrix transform used by the keyboard at compile time so that
+ * per-key tables can be sized from devicetree.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <zephyr/devicetree.h>
+
+#include <zmk/matrix.h>
+
+#if DT_HAS_CHOSEN(zmk_physical_layout)
+#define ZMK_TEMPLATE_PHYSICAL_LAYOUT_NODE DT_CHOSEN(zmk_physical_layout)
+#elif DT_HAS_COMPAT_STATUS_OKAY(zmk_physical_layout)
+#define ZMK_TEMPLATE_PHYSICAL_LAYOUT_NODE                                      \
+  DT_COMPAT_GET_ANY_STATUS_OKAY(zmk_physical_layout)
+#endif
+
+#if defined(ZMK_TEMPLATE_PHYSICAL_LAYOUT_NODE)
+#if DT_NODE_HAS_PROP(ZMK_TEMPLATE_PHYSICAL_LAYOUT_NODE, transform)
+#define ZMK_TEMPLATE_TRANSFORM_NODE                                            \
+  DT_PHANDLE(ZMK_TEMPLATE_PHYSICAL_LAYOUT_NODE, transform)
+#endif
+#endif
+
+#if !defined(ZMK_TEMPLATE_TRANSFORM_NODE) && DT_HAS_CHOSEN(zmk_matrix_transform)
+#define ZMK_TEMPLATE_TRANSFORM_NODE DT_CHOSEN(zmk_matrix_transform)
+#endif
+
+#if defined(ZMK_TEMPLATE_TRANSFORM_NODE)
+#define ZMK_TEMPLATE_MATRIX_ROWS DT_PROP(ZMK_TEMPLATE_TRANSFORM_NODE, rows)
+#define ZMK_TEMPLATE_MATRIX_COLS DT_PROP(ZMK_TEMPLATE_TRANSFORM_NODE, columns)
+#endif
+
+/**
+ * Number of key positions. Taken from the matrix transform map, or from the
+ * physical layout when no transform is defined, so per-key tables cost
+ * nothing for keys the board does not have.
+ */
+#if defined(ZMK_TEMPLATE_TRANSFORM_NODE)
+#define ZMK_TEMPLATE_KEY_COUNT DT_PROP_LEN(ZMK_TEMPLATE_TRANSFORM_NODE, map)
+#elif defined(ZMK_TEMPLATE_PHYSICAL_LAYOUT_NODE)
+#define ZMK_TEMPLATE_KEY_COUNT                                                 \
+  DT_PROP_LEN(ZMK_TEMPLATE_PHYSICAL_LAYOUT_NODE, keys)
+#else
+#define ZMK_TEMPLATE_KEY_COUNT ZMK_KEYMAP_LEN
+#endif
+
+/**
+ * Map a raw kscan row/column to a key position through the matrix transform.
+ * Returns a negative error code if the transform is unknown or the
+ * row/column has no key assigned.
+ */
+int32_t zmk_template_matrix_position(uint32_t row, uint32_t column);
+
+/**
+ * Look up the transform row/column of a key position, i.e. the inverse of
+ * zmk_template_matrix_position() before offsets are applied. Returns a
+ * negative error code if the transform is unknown or the position is out of
+ * range.
+ */
+int zmk_template_matrix_row_col(uint32_t position, uint8_t *row,
+                                uint8_t *column);
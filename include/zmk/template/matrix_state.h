@@ -0,0 +1,32 @@
+/**
+ * Template Feature - Instantaneous Matrix State
+ *
+ * One bit per key position, set while the key is down.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zmk/template/matrix.h>
+
+/**
+ * Size in bytes of the packed pressed-state bitmap.
+ */
+#define ZMK_TEMPLATE_MATRIX_STATE_BYTES DIV_ROUND_UP(ZMK_TEMPLATE_KEY_COUNT, 8)
+
+/**
+ * Update the state of the given key position. Out of range positions are
+ * ignored.
+ */
+void zmk_template_matrix_state_record(uint32_t position, bool pressed);
+
+/**
+ * Copy the pressed-state bitmap into `out`; bit `n % 8` of byte `n / 8` is
+ * position `n`. Copies a word at a time, so keys in different words may be
+ * sampled a few cycles apart. Returns the number of bytes written, at most
+ * `len`.
+ */
+size_t zmk_template_matrix_state_snapshot(uint8_t *out, size_t len);
@@ -0,0 +1,70 @@
+/**
+ * Template Feature - Scan Timing Probe
+ *
+ * Polled kscan drivers rescan from a delayable work item on the system
+ * workqueue at fixed absolute deadlines. A probe work item scheduled the
+ * same way measures how late such work actually runs, which shows directly
+ * when BLE, displays or other workloads starve the scan.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <zephyr/devicetree.h>
+
+// The kscan that actually scans the matrix: the one wrapped by the
+// diagnostics tap, or the chosen one.
+#if DT_HAS_COMPAT_STATUS_OKAY(zmk_kscan_diagnostics_tap)
+#define ZMK_TEMPLATE_SCANNED_KSCAN_NODE                                        \
+  DT_PHANDLE(DT_COMPAT_GET_ANY_STATUS_OKAY(zmk_kscan_diagnostics_tap), kscan)
+#elif DT_HAS_CHOSEN(zmk_kscan)
+#define ZMK_TEMPLATE_SCANNED_KSCAN_NODE DT_CHOSEN(zmk_kscan)
+#endif
+
+// poll-period-ms of the scanned kscan, or 0 if it has none
+#ifdef ZMK_TEMPLATE_SCANNED_KSCAN_NODE
+#define ZMK_TEMPLATE_KSCAN_POLL_PERIOD_MS                                      \
+  DT_PROP_OR(ZMK_TEMPLATE_SCANNED_KSCAN_NODE, poll_period_ms, 0)
+#else
+#define ZMK_TEMPLATE_KSCAN_POLL_PERIOD_MS 0
+#endif
+
+// Period of the probe: the Kconfig override, else the kscan poll period
+#if CONFIG_ZMK_TEMPLATE_FEATURE_SCAN_TIMING_PERIOD_MS > 0
+#define ZMK_TEMPLATE_SCAN_TIMING_PERIOD_MS                                     \
+  CONFIG_ZMK_TEMPLATE_FEATURE_SCAN_TIMING_PERIOD_MS
+#elif ZMK_TEMPLATE_KSCAN_POLL_PERIOD_MS > 0
+#define ZMK_TEMPLATE_SCAN_TIMING_PERIOD_MS ZMK_TEMPLATE_KSCAN_POLL_PERIOD_MS
+#else
+#define ZMK_TEMPLATE_SCAN_TIMING_PERIOD_MS 10
+#endif
+
+#define ZMK_TEMPLATE_SCAN_TIMING_BUCKETS 12
+
+// Bucket 0 holds lateness below 2^5 us, the last one 2^15 us and up.
+#define ZMK_TEMPLATE_SCAN_TIMING_MIN_SHIFT 5
+
+struct zmk_template_scan_timing {
+  uint32_t scans;
+  // Time covered by the statistics
+  uint32_t elapsed_ms;
+  // Interval between consecutive runs
+  uint32_t min_interval_us;
+  uint32_t max_interval_us;
+  uint32_t mean_interval_us;
+  uint64_t interval_variance_us2;
+  // Delay of each run past its deadline
+  uint32_t max_late_us;
+  uint32_t late_histogram[ZMK_TEMPLATE_SCAN_TIMING_BUCKETS];
+};
+
+/**
+ * Copy the current statistics.
+ */
+void zmk_template_scan_timing_get(struct zmk_template_scan_timing *timing);
+
+/**
+ * Restart the statistics.
+ */
+void zmk_template_scan_timing_reset(void);
@@ -0,0 +1,67 @@
+/**
+ * Template Feature - Shadow Debouncers
+ *
+ * Runs alternative debounce algorithms on the raw transitions seen by the
+ * kscan tap without acting on their output, to compare how many events each
+ * would have emitted and how much latency it would have added.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum zmk_template_shadow_debouncer {
+  // Emit on the first edge, then ignore the key for the debounce time
+  ZMK_TEMPLATE_SHADOW_EAGER,
+  // Emit once the key held still for the debounce time
+  ZMK_TEMPLATE_SHADOW_DEFER,
+  // Eager presses and deferred releases
+  ZMK_TEMPLATE_SHADOW_ASYMMETRIC,
+  ZMK_TEMPLATE_SHADOW_COUNT,
+};
+
+struct zmk_template_shadow_timing {
+  uint16_t press_ms;
+  uint16_t release_ms;
+  bool press_eager;
+  bool release_eager;
+};
+
+struct zmk_template_shadow_stats {
+  uint32_t emitted;
+  // Raw transitions that did not lead to an emitted event
+  uint32_t suppressed;
+  // Emitted later than the raw edge that started the change
+  uint32_t delayed;
+  uint64_t latency_total_us;
+  uint32_t latency_max_us;
+  // Presses emitted within the chatter window of the preceding release
+  uint32_t chatter;
+};
+
+/**
+ * Feed a raw transition of a key position, seen at `now` in kernel ticks
+ * truncated to 32 bits. Called from the analysis workqueue. O(number of
+ * debouncers).
+ */
+void zmk_template_shadow_debounce_record(uint32_t position, bool pressed,
+                                        uint32_t now);
+
+/**
+ * Number of raw transitions fed so far.
+ */
+uint32_t zmk_template_shadow_debounce_transitions(void);
+
+/**
+ * Timing of a debouncer.
+ */
+const struct zmk_template_shadow_timing *
+zmk_template_shadow_debounce_timing(enum zmk_template_shadow_debouncer d);
+
+/**
+ * Copy the statistics of a debouncer, including emissions that became due
+ * since the last raw transition of each key.
+ */
+void zmk_template_shadow_debounce_get(enum zmk_template_shadow_debouncer d,
+                                      struct zmk_template_shadow_stats *stats);
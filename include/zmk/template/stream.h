@@ -0,0 +1,30 @@
+/**
+ * Template Feature - Event Stream
+ *
+ * Pushes captured key events to the host as custom subsystem notifications
+ * instead of having it poll with ReadEvents.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct zmk_template_stream_config {
+  bool enabled;
+  // Coalescing period; 0 selects the default
+  uint32_t interval_ms;
+  // Maximum events per frame; 0 selects the maximum
+  uint32_t max_events;
+};
+
+/**
+ * Start, reconfigure or stop the stream. `config` is clamped in place to the
+ * values actually used. Must be called from the Studio RPC thread.
+ */
+void zmk_template_stream_configure(struct zmk_template_stream_config *config);
+
+/**
+ * Whether the stream currently owns the consumer side of the capture ring.
+ */
+bool zmk_template_stream_enabled(void);
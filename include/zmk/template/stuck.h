@@ -0,0 +1,34 @@
+/**
+ * Template Feature - Stuck Key Watchdog
+ *
+ * Flags keys held down longer than a configurable threshold, using a single
+ * delayable work item for all keys.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zmk/template/matrix.h>
+
+#define ZMK_TEMPLATE_STUCK_THRESHOLD_MS                                        \
+  CONFIG_ZMK_TEMPLATE_FEATURE_STUCK_THRESHOLD_MS
+
+/**
+ * Feed a key transition from the analysis workqueue. O(1); the deadline scan
+ * runs on the same queue, and stuck key events are raised from the system
+ * workqueue.
+ */
+void zmk_template_stuck_record(uint32_t position, bool pressed);
+
+/**
+ * Whether the key is currently flagged as stuck. `held_ms` receives how long
+ * it has been held down.
+ */
+bool zmk_template_stuck_get(uint32_t position, uint32_t *held_ms);
+
+/**
+ * Number of times a key was flagged as stuck since boot.
+ */
+uint32_t zmk_template_stuck_total(void);
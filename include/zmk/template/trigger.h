@@ -0,0 +1,91 @@
+/**
+ * Template Feature - Trigger Capture
+ *
+ * Logic-analyzer style capture: while armed, events go into a circular
+ * pre-trigger buffer. When the trigger condition is met, capture continues
+ * for a post-trigger window and the slice around the trigger is frozen until
+ * the host downloads it and re-arms.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zmk/template/event_ring.h>
+
+#define ZMK_TEMPLATE_TRIGGER_BUFFER_SIZE                                       \
+  CONFIG_ZMK_TEMPLATE_FEATURE_TRIGGER_BUFFER_SIZE
+
+// Values match the TriggerKind enum in custom.proto
+enum zmk_template_trigger_kind {
+  ZMK_TEMPLATE_TRIGGER_NONE,
+  // A press of `position`
+  ZMK_TEMPLATE_TRIGGER_KEY,
+  // A press classified as chatter
+  ZMK_TEMPLATE_TRIGGER_CHATTER,
+  // A press that makes `simultaneous_keys` or more keys held down at once
+  ZMK_TEMPLATE_TRIGGER_SIMULTANEOUS,
+  // A key flagged by the stuck key watchdog
+  ZMK_TEMPLATE_TRIGGER_STUCK,
+};
+
+// Values match the TriggerState enum in custom.proto
+enum zmk_template_trigger_state {
+  ZMK_TEMPLATE_TRIGGER_IDLE,
+  ZMK_TEMPLATE_TRIGGER_ARMED,
+  ZMK_TEMPLATE_TRIGGER_TRIGGERED,
+  ZMK_TEMPLATE_TRIGGER_DONE,
+};
+
+struct zmk_template_trigger_config {
+  enum zmk_template_trigger_kind kind;
+  uint32_t position;
+  uint32_t simultaneous_keys;
+  // Events kept before and captured after the triggering one
+  uint32_t pre_events;
+  uint32_t post_events;
+};
+
+/**
+ * Arm the trigger, discarding any previous capture. A kind of
+ * ZMK_TEMPLATE_TRIGGER_NONE disarms it. `config` is clamped in place to the
+ * buffer size.
+ */
+void zmk_template_trigger_arm(struct zmk_template_trigger_config *config);
+
+enum zmk_template_trigger_state zmk_template_trigger_get_state(void);
+
+/**
+ * Copy the configuration in effect.
+ */
+void zmk_template_trigger_get_config(struct zmk_template_trigger_config *out);
+
+/**
+ * Feed a captured event. `chatter` tells whether the chatter detector flagged
+ * it and `pressed_keys` is the number of keys held down after it. O(1).
+ */
+void zmk_template_trigger_record(const struct zmk_template_key_event *ev,
+                                 bool chatter, uint32_t pressed_keys);
+
+/**
+ * Fire a trigger of a kind detected outside the capture path. The trigger
+ * point is the next captured event, so the slice holds the events before the
+ * detection and post_events after it.
+ */
+void zmk_template_trigger_fire(enum zmk_template_trigger_kind kind);
+
+/**
+ * Size of the frozen slice once the state is ZMK_TEMPLATE_TRIGGER_DONE, or 0
+ * before that. `trigger_index` receives the index of the triggering event
+ * within the slice.
+ */
+size_t zmk_template_trigger_slice(size_t *trigger_index);
+
+/**
+ * Copy event `index` of the frozen slice. Returns false if out of range or
+ * the capture is not done.
+ */
+bool zmk_template_trigger_slice_event(size_t index,
+                                      struct zmk_template_key_event *out);
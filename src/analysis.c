@@ -0,0 +1,226 @@
+/**
+ * Template Feature - Deferred Analysis
+ *
+ * The capture path is the single producer of the analysis ring and the
+ * workqueue its single consumer. Raw transitions come from the kscan
+ * callback, which may be a different context, so they have a ring of their
+ * own. Every statistic below is only updated from the queue, so each keeps a
+ * single writer.
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+
+#include <zmk/template/analysis.h>
+#include <zmk/template/bounce.h>
+#include <zmk/template/budget.h>
+#include <zmk/template/chatter.h>
+#include <zmk/template/cycles.h>
+#include <zmk/template/ghost.h>
+#include <zmk/template/hold_quantiles.h>
+#include <zmk/template/key_counters.h>
+#include <zmk/template/matrix.h>
+#include <zmk/template/matrix_state.h>
+#include <zmk/template/shadow_debounce.h>
+#include <zmk/template/stuck.h>
+#include <zmk/template/trigger.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+ZMK_TEMPLATE_EVENT_RING_DEFINE(analysis_ring,
+                               CONFIG_ZMK_TEMPLATE_FEATURE_ANALYSIS_RING_SIZE);
+
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_SHADOW_DEBOUNCE)
+ZMK_TEMPLATE_EVENT_RING_DEFINE(raw_ring,
+                               CONFIG_ZMK_TEMPLATE_FEATURE_ANALYSIS_RING_SIZE);
+#endif
+
+K_THREAD_STACK_DEFINE(analysis_stack,
+                      CONFIG_ZMK_TEMPLATE_FEATURE_ANALYSIS_STACK_SIZE);
+
+static struct k_work_q analysis_queue;
+
+static atomic_t generation = ATOMIC_INIT(1);
+static atomic_t dropped;
+
+// Keys held down as seen by the analysis, for the trigger
+static ATOMIC_DEFINE(held, ZMK_TEMPLATE_KEY_COUNT);
+static uint32_t pressed_keys;
+static uint32_t release_count;
+// Value of `dropped` when the held state was last resynced
+static uint32_t resynced_dropped;
+
+static void analyse(const struct zmk_template_key_event *ev) {
+  if (ev->kind == ZMK_TEMPLATE_KEY_EVENT_BURST) {
+    zmk_template_bounce_record(
+        ev->position, ev->pressed,
+        ZMK_TEMPLATE_BURST_REJECTED(ev->timestamp),
+        ZMK_TEMPLATE_BURST_DURATION_US(ev->timestamp));
+    atomic_inc(&generation);
+    return;
+  }
+
+  // Only published once the statistics are updated, so a reader that saw a
+  // generation also sees everything stamped with it.
+  uint32_t next_generation = (uint32_t)atomic_get(&generation) + 1;
+
+  if (ev->position < ZMK_TEMPLATE_KEY_COUNT) {
+    if (ev->pressed && !atomic_test_and_set_bit(held, ev->position)) {
+      pressed_keys++;
+    } else if (!ev->pressed &&
+               atomic_test_and_clear_bit(held, ev->position)) {
+      pressed_keys--;
+    }
+  }
+
+  enum zmk_template_budget_mode mode = zmk_template_budget_mode();
+
+  // Counters, the per-key state that ghost and stuck key detection need to
+  // stay correct and the trigger's pre-trigger buffer are kept in every mode.
+  zmk_template_key_counters_record(ev->position, ev->pressed, next_generation);
+  zmk_template_ghost_record(ev->position, ev->pressed, ev->timestamp);
+  zmk_template_stuck_record(ev->position, ev->pressed);
+
+  bool chatter = false;
+  if (mode == ZMK_TEMPLATE_BUDGET_COUNTERS) {
+    // Presses are cheap and keep the start of the next hold known.
+    if (ev->pressed) {
+      zmk_template_hold_quantiles_record(ev->position, true, ev->timestamp);
+    }
+  } else {
+    chatter =
+        zmk_template_chatter_record(ev->position, ev->pressed, ev->timestamp);
+
+    // When sampling, only 1 in N holds updates the estimators.
+    if (ev->pressed || mode == ZMK_TEMPLATE_BUDGET_FULL ||
+        release_count++ % CONFIG_ZMK_TEMPLATE_FEATURE_BUDGET_SAMPLE_EVERY ==
+            0) {
+      zmk_template_hold_quantiles_record(ev->position, ev->pressed,
+                                         ev->timestamp);
+    }
+  }
+  zmk_template_trigger_record(ev, chatter, pressed_keys);
+
+  atomic_set(&generation, (atomic_val_t)next_generation);
+}
+
+/**
+ * Release the keys the analysis still holds down but the matrix no longer
+ * does. A dropped release would otherwise leave them held, stuck and timing
+ * a hold forever. A dropped press only loses that one press. Releases
+ * captured after the snapshot find the key already released and are
+ * ignored.
+ */
+static void resync_held(void) {
+  uint8_t matrix[ZMK_TEMPLATE_MATRIX_STATE_BYTES];
+
+  zmk_template_matrix_state_snapshot(matrix, sizeof(matrix));
+  for (uint32_t pos = 0; pos < ZMK_TEMPLATE_KEY_COUNT; pos++) {
+    if ((matrix[pos / 8] & BIT(pos % 8)) ||
+        !atomic_test_and_clear_bit(held, pos)) {
+      continue;
+    }
+
+    LOG_DBG("position %d release was dropped", pos);
+    pressed_keys--;
+    zmk_template_ghost_record(pos, false, 0);
+    zmk_template_stuck_record(pos, false);
+    zmk_template_hold_quantiles_forget(pos);
+  }
+}
+
+static void analysis_drain(struct k_work *work) {
+  struct zmk_template_key_event ev;
+
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_SHADOW_DEBOUNCE)
+  while (zmk_template_event_ring_get(&raw_ring, &ev, 1) == 1) {
+    zmk_template_cycles_t start = zmk_template_cycles_now();
+
+    zmk_template_shadow_debounce_record(ev.position, ev.pressed,
+                                        ev.timestamp);
+    zmk_template_budget_account(zmk_template_cycles_since(start), false);
+  }
+#endif
+
+  while (zmk_template_event_ring_get(&analysis_ring, &ev, 1) == 1) {
+    zmk_template_cycles_t start = zmk_template_cycles_now();
+
+    analyse(&ev);
+    zmk_template_budget_account(zmk_template_cycles_since(start), false);
+  }
+
+  uint32_t lost = (uint32_t)atomic_get(&dropped);
+  if (lost != resynced_dropped) {
+    resynced_dropped = lost;
+    resync_held();
+  }
+}
+
+static K_WORK_DEFINE(analysis_work, analysis_drain);
+
+void zmk_template_analysis_submit(const struct zmk_template_key_event *ev) {
+  if (!zmk_template_event_ring_put(&analysis_ring, ev)) {
+    atomic_inc(&dropped);
+    return;
+  }
+
+  // Events queued before the workqueue started are drained once it does.
+  k_work_submit_to_queue(&analysis_queue, &analysis_work);
+}
+
+struct k_work_q *zmk_template_analysis_queue(void) { return &analysis_queue; }
+
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_SHADOW_DEBOUNCE)
+void zmk_template_analysis_submit_raw(uint32_t position, bool pressed) {
+  struct zmk_template_key_event ev = {
+      .timestamp = (uint32_t)k_uptime_ticks(),
+      .position = (uint16_t)position,
+      .pressed = pressed,
+      .kind = ZMK_TEMPLATE_KEY_EVENT_RAW,
+  };
+
+  if (!zmk_template_event_ring_put(&raw_ring, &ev)) {
+    atomic_inc(&dropped);
+    return;
+  }
+  k_work_submit_to_queue(&analysis_queue, &analysis_work);
+}
+#endif
+
+void zmk_template_analysis_submit_burst(uint32_t position, bool pressed,
+                                        uint32_t rejected,
+                                        uint32_t duration_us) {
+  struct zmk_template_key_event ev = {
+      .timestamp = ZMK_TEMPLATE_BURST_TIMESTAMP(rejected, duration_us),
+      .position = (uint16_t)position,
+      .pressed = pressed,
+      .kind = ZMK_TEMPLATE_KEY_EVENT_BURST,
+  };
+
+  zmk_template_analysis_submit(&ev);
+}
+
+uint32_t zmk_template_analysis_generation(void) {
+  return (uint32_t)atomic_get(&generation);
+}
+
+uint32_t zmk_template_analysis_dropped(void) {
+  return (uint32_t)atomic_get(&dropped);
+}
+
+static int template_analysis_init(void) {
+  const struct k_work_queue_config config = {
+      .name = "template_analysis",
+  };
+
+  k_work_queue_init(&analysis_queue);
+  k_work_queue_start(&analysis_queue, analysis_stack,
+                     K_THREAD_STACK_SIZEOF(analysis_stack),
+                     CONFIG_ZMK_TEMPLATE_FEATURE_ANALYSIS_PRIORITY, &config);
+  k_work_submit_to_queue(&analysis_queue, &analysis_work);
+  return 0;
+}
+
+SYS_INIT(template_analysis_init, POST_KERNEL,
+         CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,140 @@
+/**
+ * Template Feature - Behavior Latency
+ *
+ * zmk_behavior_invoke_binding() is wrapped at link time (-Wl,--wrap). The
+ * first binding pressed for a key event owns it; behaviors such as hold-tap,
+ * tap-dance, mod-morph and macros invoke further bindings carrying the
+ * timestamp of that same key event, and the first of those marks when the
+ * owner let the keypress through. The owner is charged the time between its
+ * own invocation and that child's, so delays added upstream, e.g. by combos
+ * or the owner being invoked late, are not counted twice. A binding that
+ * never invokes another added no delay of its own and is recorded with 0
+ * once the next key event for its position arrives, since a deferred child
+ * could still follow its release.
+ *
+ * Key event timestamps come from k_uptime_get(), so delays have millisecond
+ * resolution. Bindings are invoked from the system work queue one at a time.
+ * The bookkeeping counts against the overhead budget.
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+
+#include <zmk/behavior.h>
+#include <zmk/template/behavior_latency.h>
+#include <zmk/template/budget.h>
+#include <zmk/template/cycles.h>
+#include <zmk/template/matrix.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define MAX_BEHAVIORS CONFIG_ZMK_TEMPLATE_FEATURE_BEHAVIOR_LATENCY_MAX
+
+static struct zmk_template_behavior_latency entries[MAX_BEHAVIORS] = {
+    [ZMK_TEMPLATE_BEHAVIOR_LATENCY_COMBO] = {.name = "combo"},
+};
+
+// The key event a position is currently attributed to
+struct key_owner {
+  int64_t timestamp;
+  uint32_t own_delay_ms;
+  uint8_t owner;
+  bool pending;
+};
+
+static struct key_owner keys[ZMK_TEMPLATE_KEY_COUNT];
+
+// Last combo recorded, so bindings it invokes in turn are not counted again
+static struct {
+  int64_t timestamp;
+  uint32_t position;
+} last_combo;
+
+static int entry_index(const char *name) {
+  for (int i = ZMK_TEMPLATE_BEHAVIOR_LATENCY_COMBO + 1; i < MAX_BEHAVIORS;
+       i++) {
+    if (entries[i].name == NULL) {
+      entries[i].name = name;
+      return i;
+    }
+    if (entries[i].name == name || strcmp(entries[i].name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void record(int index, uint32_t delay_ms) {
+  zmk_template_latency_histogram_add(&entries[index].histogram,
+                                     delay_ms * 1000);
+}
+
+static void binding_pressed(const char *name,
+                            const struct zmk_behavior_binding_event *event) {
+  uint32_t delay_ms = MAX(k_uptime_get() - event->timestamp, 0);
+
+  if (event->position >= ZMK_TEMPLATE_KEY_COUNT) {
+    // Virtual positions past the physical keys belong to combos.
+    if (last_combo.timestamp != event->timestamp ||
+        last_combo.position != event->position) {
+      last_combo.timestamp = event->timestamp;
+      last_combo.position = event->position;
+      record(ZMK_TEMPLATE_BEHAVIOR_LATENCY_COMBO, delay_ms);
+    }
+    return;
+  }
+
+  struct key_owner *key = &keys[event->position];
+
+  if (key->pending && key->timestamp == event->timestamp) {
+    // A binding invoked on behalf of the owner, after the owner held it back
+    record(key->owner, delay_ms - MIN(delay_ms, key->own_delay_ms));
+    key->pending = false;
+    return;
+  }
+  if (key->timestamp == event->timestamp) {
+    return;
+  }
+
+  // A new key event: the previous owner invoked nothing, so it held nothing
+  // back.
+  if (key->pending) {
+    record(key->owner, 0);
+  }
+
+  int index = entry_index(name);
+
+  key->timestamp = event->timestamp;
+  key->own_delay_ms = delay_ms;
+  key->owner = index < 0 ? 0 : index;
+  key->pending = index >= 0;
+}
+
+int __real_zmk_behavior_invoke_binding(
+    const struct zmk_behavior_binding *src_binding,
+    struct zmk_behavior_binding_event event, bool pressed);
+
+int __wrap_zmk_behavior_invoke_binding(
+    const struct zmk_behavior_binding *src_binding,
+    struct zmk_behavior_binding_event event, bool pressed) {
+  if (pressed) {
+    zmk_template_cycles_t start = zmk_template_cycles_now();
+
+    binding_pressed(src_binding->behavior_dev, &event);
+    zmk_template_budget_account(zmk_template_cycles_since(start), false);
+  }
+
+  return __real_zmk_behavior_invoke_binding(src_binding, event, pressed);
+}
+
+int zmk_template_behavior_latency_count(void) { return MAX_BEHAVIORS; }
+
+const struct zmk_template_behavior_latency *
+zmk_template_behavior_latency_get(int index) {
+  if (index < 0 || index >= MAX_BEHAVIORS) {
+    return NULL;
+  }
+  return &entries[index];
+}
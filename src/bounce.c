@@ -0,0 +1,44 @@
+/**
+ * Template Feature - Debounce Rejection Statistics
+ */
+
+#include <zephyr/kernel.h>
+
+#include <zmk/template/bounce.h>
+#include <zmk/template/histogram.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static struct zmk_template_bounce_stats bounce_stats;
+
+void zmk_template_bounce_record(uint32_t position, bool pressed,
+                                uint32_t rejected, uint32_t duration_us) {
+  if (rejected == 0 || position >= ZMK_TEMPLATE_KEY_COUNT) {
+    return;
+  }
+
+  for (uint32_t i = 0; i < rejected; i++) {
+    zmk_template_counter_inc(&bounce_stats.rejected[position]);
+  }
+  zmk_template_counter_inc(&bounce_stats.bursts[position]);
+
+  uint16_t *max_us = &bounce_stats.max_burst_us[position];
+  *max_us = MAX(*max_us, MIN(duration_us, UINT16_MAX));
+
+  uint8_t bucket =
+      zmk_template_log2_bucket(duration_us, ZMK_TEMPLATE_BOUNCE_MIN_SHIFT,
+                               ZMK_TEMPLATE_BOUNCE_BUCKETS);
+  if (pressed) {
+    bounce_stats.press_histogram[bucket]++;
+  } else {
+    bounce_stats.release_histogram[bucket]++;
+  }
+
+  LOG_DBG("position %d %s burst rejected %d bucket %d", position,
+          pressed ? "press" : "release", rejected, bucket);
+}
+
+const struct zmk_template_bounce_stats *zmk_template_bounce_get(void) {
+  return &bounce_stats;
+}
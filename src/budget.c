@@ -0,0 +1,99 @@
+/**
+ * Template Feature - Overhead Budget
+ *
+ * Cycles are summed over windows of CONFIG_ZMK_TEMPLATE_FEATURE_BUDGET_
+ * WINDOW_MS. A window is closed by the first account call after it ends, so
+ * an idle keyboard wakes nothing. Each window over budget steps the mode
+ * down; RECOVER_WINDOWS consecutive windows below a quarter of the budget
+ * step it back up.
+ */
+
+#include <zephyr/kernel.h>
+
+#include <zmk/template/budget.h>
+#include <zmk/template/cycles.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define BUDGET_PPM CONFIG_ZMK_TEMPLATE_FEATURE_BUDGET_PPM
+#define WINDOW_MS CONFIG_ZMK_TEMPLATE_FEATURE_BUDGET_WINDOW_MS
+#define RECOVER_WINDOWS 10
+
+static struct k_spinlock lock;
+
+static struct zmk_template_budget_stats stats;
+static atomic_t mode;
+
+static int64_t window_start;
+static uint64_t window_cycles;
+static uint32_t quiet_windows;
+static uint32_t event_max_cycles;
+
+// Must be called with the lock held.
+static void close_window(int64_t now) {
+  uint64_t window_ns = (uint64_t)(now - window_start) * NSEC_PER_MSEC;
+  uint64_t spent_ns = zmk_template_cycles_to_ns(window_cycles);
+  enum zmk_template_budget_mode current = atomic_get(&mode);
+
+  stats.overhead_ppm = MIN(spent_ns * 1000000 / window_ns, UINT32_MAX);
+  window_start = now;
+  window_cycles = 0;
+
+  if (BUDGET_PPM == 0) {
+    return;
+  }
+
+  if (stats.overhead_ppm > BUDGET_PPM) {
+    quiet_windows = 0;
+    if (current < ZMK_TEMPLATE_BUDGET_COUNTERS) {
+      atomic_set(&mode, current + 1);
+      stats.step_downs++;
+      LOG_WRN("Diagnostics overhead %d ppm over budget, stepping down to "
+              "mode %d",
+              stats.overhead_ppm, current + 1);
+    }
+  } else if (stats.overhead_ppm < BUDGET_PPM / 4) {
+    if (current > ZMK_TEMPLATE_BUDGET_FULL &&
+        ++quiet_windows >= RECOVER_WINDOWS) {
+      quiet_windows = 0;
+      atomic_set(&mode, current - 1);
+      LOG_INF("Diagnostics overhead back to %d ppm, stepping up to mode %d",
+              stats.overhead_ppm, current - 1);
+    }
+  } else {
+    quiet_windows = 0;
+  }
+}
+
+void zmk_template_budget_account(uint32_t cycles, bool event) {
+  int64_t now = k_uptime_get();
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  if (now - window_start >= WINDOW_MS) {
+    close_window(now);
+  }
+
+  window_cycles += cycles;
+  if (event) {
+    stats.events++;
+    stats.event_total_ns += zmk_template_cycles_to_ns(cycles);
+    event_max_cycles = MAX(event_max_cycles, cycles);
+  }
+
+  k_spin_unlock(&lock, key);
+}
+
+enum zmk_template_budget_mode zmk_template_budget_mode(void) {
+  return atomic_get(&mode);
+}
+
+void zmk_template_budget_get(struct zmk_template_budget_stats *out) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  *out = stats;
+  out->mode = atomic_get(&mode);
+  out->event_max_ns = zmk_template_cycles_to_ns(event_max_cycles);
+
+  k_spin_unlock(&lock, key);
+}
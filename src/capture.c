@@ -0,0 +1,118 @@
+/**
+ * Template Feature - Key Event Capture
+ *
+ * Feeds key transitions into the lock-free capture ring and hands them to the
+ * analysis workqueue. When a `zmk,kscan-diagnostics-tap` is present it calls
+ * in directly from the kscan callback; otherwise local position changes are
+ * used as the source.
+ */
+
+#include <zephyr/kernel.h>
+
+#include <zmk/event_manager.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/template/analysis.h>
+#include <zmk/template/budget.h>
+#include <zmk/template/capture.h>
+#include <zmk/template/cycles.h>
+#include <zmk/template/hid_stats.h>
+#include <zmk/template/latency.h>
+#include <zmk/template/matrix_state.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+ZMK_TEMPLATE_EVENT_RING_DEFINE(capture_ring,
+                               CONFIG_ZMK_TEMPLATE_FEATURE_EVENT_RING_SIZE);
+
+// Only touched from the capture path, the ring's single producer
+static uint32_t sample_count;
+// Events kept out of the ring by sampling, until the next read
+static atomic_t sampled_out;
+
+static bool capture_sampled(void) {
+  switch (zmk_template_budget_mode()) {
+  case ZMK_TEMPLATE_BUDGET_FULL:
+    return true;
+  case ZMK_TEMPLATE_BUDGET_SAMPLED:
+    return sample_count++ % CONFIG_ZMK_TEMPLATE_FEATURE_BUDGET_SAMPLE_EVERY ==
+           0;
+  default:
+    return false;
+  }
+}
+
+void zmk_template_capture_key_event(uint32_t position, bool pressed) {
+  zmk_template_cycles_t start = zmk_template_cycles_now();
+  struct zmk_template_key_event ev = {
+      .timestamp = k_cycle_get_32(),
+      .position = (uint16_t)position,
+      .pressed = pressed,
+  };
+
+  zmk_template_matrix_state_record(position, pressed);
+  if (capture_sampled()) {
+    zmk_template_event_ring_put(&capture_ring, &ev);
+  } else {
+    atomic_inc(&sampled_out);
+  }
+  zmk_template_analysis_submit(&ev);
+
+  // Only the tap sees transitions before they become position events.
+  if (IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_KSCAN_TAP) &&
+      IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_LATENCY)) {
+    zmk_template_latency_kscan(position, start);
+  }
+  if (IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_HID_STATS)) {
+    zmk_template_hid_stats_transition();
+  }
+
+  zmk_template_budget_account(zmk_template_cycles_since(start), true);
+}
+
+size_t zmk_template_capture_read(struct zmk_template_key_event *out,
+                                 size_t max) {
+  return zmk_template_event_ring_get(&capture_ring, out, max);
+}
+
+bool zmk_template_capture_peek(size_t index,
+                               struct zmk_template_key_event *out) {
+  return zmk_template_event_ring_peek(&capture_ring, index, out);
+}
+
+void zmk_template_capture_consume(size_t count) {
+  zmk_template_event_ring_skip(&capture_ring, count);
+}
+
+size_t zmk_template_capture_pending(void) {
+  return zmk_template_event_ring_size(&capture_ring);
+}
+
+uint32_t zmk_template_capture_take_dropped(void) {
+  return zmk_template_event_ring_take_dropped(&capture_ring);
+}
+
+uint32_t zmk_template_capture_take_sampled_out(void) {
+  return (uint32_t)atomic_clear(&sampled_out);
+}
+
+#if !IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_KSCAN_TAP)
+
+static int template_capture_listener(const zmk_event_t *eh) {
+  const struct zmk_position_state_changed *ev =
+      as_zmk_position_state_changed(eh);
+
+  // Peripheral positions arriving over split transport were already scanned
+  // elsewhere; only local transitions are captured.
+  if (ev == NULL || ev->source != ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL) {
+    return ZMK_EV_EVENT_BUBBLE;
+  }
+
+  zmk_template_capture_key_event(ev->position, ev->state);
+  return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(template_capture, template_capture_listener);
+ZMK_SUBSCRIPTION(template_capture, zmk_position_state_changed);
+
+#endif
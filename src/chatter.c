@@ -0,0 +1,50 @@
+/**
+ * Template Feature - Chatter Detection
+ */
+
+#include <zephyr/kernel.h>
+
+#include <zmk/template/chatter.h>
+#include <zmk/template/histogram.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define WINDOW_US (CONFIG_ZMK_TEMPLATE_FEATURE_CHATTER_WINDOW_MS * 1000U)
+
+static struct zmk_template_chatter_stats chatter_stats;
+
+static uint32_t last_press[ZMK_TEMPLATE_KEY_COUNT];
+static ATOMIC_DEFINE(pressed_before, ZMK_TEMPLATE_KEY_COUNT);
+
+bool zmk_template_chatter_record(uint32_t position, bool pressed,
+                                 uint32_t timestamp) {
+  if (!pressed || position >= ZMK_TEMPLATE_KEY_COUNT) {
+    return false;
+  }
+
+  uint32_t previous = last_press[position];
+  last_press[position] = timestamp;
+
+  if (!atomic_test_and_set_bit(pressed_before, position)) {
+    return false;
+  }
+
+  uint32_t interval_us = k_cyc_to_us_floor32(timestamp - previous);
+  if (interval_us >= WINDOW_US) {
+    return false;
+  }
+
+  uint8_t bucket =
+      zmk_template_log2_bucket(interval_us, ZMK_TEMPLATE_CHATTER_MIN_SHIFT,
+                               ZMK_TEMPLATE_CHATTER_BUCKETS);
+  zmk_template_counter_inc(&chatter_stats.histogram[position][bucket]);
+  chatter_stats.total++;
+
+  LOG_DBG("position %d chatter bucket %d", position, bucket);
+  return true;
+}
+
+const struct zmk_template_chatter_stats *zmk_template_chatter_get(void) {
+  return &chatter_stats;
+}
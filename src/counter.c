@@ -0,0 +1,82 @@
+/**
+ * Template Feature - Tiered Counters
+ *
+ * Overflow slots are handed out on the first wrap of a counter, which keeps
+ * the slot's index, and are never freed; counters only grow. The lock only
+ * guards the carry, where the hot value and its slot change together; plain
+ * increments are single writer.
+ */
+
+#include <zephyr/kernel.h>
+
+#include <zmk/template/counter.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_COUNTER_WIDTH_32)
+
+uint32_t zmk_template_counter_read(const zmk_template_counter_t *counter) {
+  return *counter;
+}
+
+uint32_t zmk_template_counter_lost(void) { return 0; }
+
+#else
+
+#define OVERFLOW_SLOTS CONFIG_ZMK_TEMPLATE_FEATURE_COUNTER_OVERFLOW_SLOTS
+
+BUILD_ASSERT(OVERFLOW_SLOTS <= UINT8_MAX, "Slot indexes are one byte wide");
+
+static struct k_spinlock lock;
+
+// Number of times the hot value of the counter holding each slot wrapped
+static uint32_t overflow[OVERFLOW_SLOTS];
+static uint8_t overflow_used;
+static uint32_t lost;
+
+void zmk_template_counter_carry(zmk_template_counter_t *counter) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  bool first_loss = false;
+
+  if (counter->slot == 0 && overflow_used < OVERFLOW_SLOTS) {
+    counter->slot = ++overflow_used;
+  }
+
+  if (counter->slot != 0) {
+    overflow[counter->slot - 1]++;
+    counter->value = 0;
+  } else {
+    // Saturate rather than wrap so the value stays a lower bound
+    first_loss = lost++ == 0;
+  }
+
+  k_spin_unlock(&lock, key);
+
+  if (first_loss) {
+    LOG_WRN("Counter overflow slots exhausted, counter saturated");
+  }
+}
+
+uint32_t zmk_template_counter_read(const zmk_template_counter_t *counter) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  uint32_t value = counter->value;
+
+  if (counter->slot != 0) {
+    value += overflow[counter->slot - 1] *
+             ((uint32_t)ZMK_TEMPLATE_COUNTER_MAX + 1);
+  }
+
+  k_spin_unlock(&lock, key);
+  return value;
+}
+
+uint32_t zmk_template_counter_lost(void) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  uint32_t value = lost;
+
+  k_spin_unlock(&lock, key);
+  return value;
+}
+
+#endif
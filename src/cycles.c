@@ -0,0 +1,16 @@
+/**
+ * Template Feature - Cycle Counting
+ *
+ * Starts the Zephyr timing functions backing zmk_template_cycles_now().
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/timing/timing.h>
+
+static int template_cycles_init(void) {
+  timing_init();
+  timing_start();
+  return 0;
+}
+
+SYS_INIT(template_cycles_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
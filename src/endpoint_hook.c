@@ -0,0 +1,26 @@
+/**
+ * Template Feature - HID Endpoint Hook
+ *
+ * ZMK raises no event when a HID report is sent, so the module wraps
+ * zmk_endpoints_send_report() at link time (-Wl,--wrap) to observe it.
+ */
+
+#include <stdint.h>
+
+#include <zmk/template/cycles.h>
+#include <zmk/template/hid_stats.h>
+#include <zmk/template/latency.h>
+
+int __real_zmk_endpoints_send_report(uint16_t usage_page);
+
+int __wrap_zmk_endpoints_send_report(uint16_t usage_page) {
+  zmk_template_cycles_t start = zmk_template_cycles_now();
+  int ret = __real_zmk_endpoints_send_report(usage_page);
+  uint32_t cycles = zmk_template_cycles_since(start);
+
+  zmk_template_latency_report_sent();
+  if (IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_HID_STATS)) {
+    zmk_template_hid_stats_report(cycles, ret);
+  }
+  return ret;
+}
@@ -0,0 +1,255 @@
+/**
+ * Template Feature - Event Dispatch Profile
+ *
+ * zmk_event_manager_raise(), raise_after(), raise_at() and release() are
+ * wrapped at link time (-Wl,--wrap) and dispatch the event themselves, so
+ * every listener call can be timed. The loop mirrors the event manager's
+ * own: listeners run in subscription order until one handles, captures or
+ * fails the event, and handled or failed events are freed.
+ *
+ * The profile table follows the event type registry; types beyond
+ * CONFIG_ZMK_TEMPLATE_FEATURE_EVENT_PROFILE_MAX_TYPES are dispatched but
+ * not profiled. The time spent around the listeners counts against the
+ * overhead budget, and nothing is timed once the budget is down to counters.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+
+#include <zmk/event_manager.h>
+#include <zmk/template/budget.h>
+#include <zmk/template/cycles.h>
+#include <zmk/template/event_profile.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define MAX_TYPES CONFIG_ZMK_TEMPLATE_FEATURE_EVENT_PROFILE_MAX_TYPES
+
+extern struct zmk_event_type *__event_type_start[];
+extern struct zmk_event_type *__event_type_end[];
+extern struct zmk_event_subscription __event_subscriptions_start[];
+extern struct zmk_event_subscription __event_subscriptions_end[];
+
+struct type_profile {
+  uint32_t dispatches;
+  uint64_t total_cycles;
+  uint32_t max_cycles;
+  uint32_t slowest_cycles;
+  const struct zmk_listener *slowest_listener;
+};
+
+static struct k_spinlock lock;
+
+static struct type_profile profiles[MAX_TYPES];
+
+// Direct-mapped cache of registry indexes by type, so a dispatch does not
+// scan the registry. -1 marks types that are not profiled.
+#define INDEX_CACHE_SIZE 16
+
+static struct {
+  const struct zmk_event_type *type;
+  int index;
+} index_cache[INDEX_CACHE_SIZE];
+
+// Must be called with the lock held.
+static int type_index_locked(const struct zmk_event_type *type) {
+  size_t slot = ((uintptr_t)type / sizeof(*type)) % INDEX_CACHE_SIZE;
+
+  if (index_cache[slot].type == type) {
+    return index_cache[slot].index;
+  }
+
+  int count = MIN(__event_type_end - __event_type_start, MAX_TYPES);
+  int index = -1;
+
+  for (int i = 0; i < count; i++) {
+    if (__event_type_start[i] == type) {
+      index = i;
+      break;
+    }
+  }
+  index_cache[slot].type = type;
+  index_cache[slot].index = index;
+  return index;
+}
+
+static void record(const struct zmk_event_type *type, bool raised,
+                   uint32_t cycles, const struct zmk_listener *slowest,
+                   uint32_t slowest_cycles) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  int index = type_index_locked(type);
+
+  if (index < 0) {
+    k_spin_unlock(&lock, key);
+    return;
+  }
+
+  struct type_profile *p = &profiles[index];
+
+  if (raised) {
+    p->dispatches++;
+  }
+  p->total_cycles += cycles;
+  p->max_cycles = MAX(p->max_cycles, cycles);
+  if (slowest != NULL && slowest_cycles >= p->slowest_cycles) {
+    p->slowest_cycles = slowest_cycles;
+    p->slowest_listener = slowest;
+  }
+
+  k_spin_unlock(&lock, key);
+}
+
+/**
+ * Record a dispatch that spent `total_cycles` in listeners, and account the
+ * rest of the time since `entered` to the budget.
+ */
+static void finish(const struct zmk_event_type *type, bool raised,
+                   zmk_template_cycles_t entered, uint32_t total_cycles,
+                   const struct zmk_listener *slowest,
+                   uint32_t slowest_cycles) {
+  record(type, raised, total_cycles, slowest, slowest_cycles);
+  zmk_template_budget_account(
+      zmk_template_cycles_since(entered) - total_cycles, false);
+}
+
+static int handle_from(zmk_event_t *event, uint8_t start_index, bool raised) {
+  zmk_template_cycles_t entered = zmk_template_cycles_now();
+  // The event may be freed below; its type lives in flash.
+  const struct zmk_event_type *type = event->event;
+  const struct zmk_listener *slowest = NULL;
+  uint32_t slowest_cycles = 0;
+  uint32_t total_cycles = 0;
+  uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
+  bool profiled = zmk_template_budget_mode() != ZMK_TEMPLATE_BUDGET_COUNTERS;
+  int ret = 0;
+
+  for (int i = start_index; i < len; i++) {
+    struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
+
+    if (ev_sub->event_type != type) {
+      continue;
+    }
+
+    event->last_listener_index = i;
+
+    if (!profiled) {
+      ret = ev_sub->listener->callback(event);
+    } else {
+      zmk_template_cycles_t start = zmk_template_cycles_now();
+      ret = ev_sub->listener->callback(event);
+      uint32_t cycles = zmk_template_cycles_since(start);
+
+      total_cycles += cycles;
+      if (slowest == NULL || cycles > slowest_cycles) {
+        slowest = ev_sub->listener;
+        slowest_cycles = cycles;
+      }
+    }
+
+    switch (ret) {
+    case ZMK_EV_EVENT_BUBBLE:
+      continue;
+    case ZMK_EV_EVENT_HANDLED:
+      ret = 0;
+      goto release;
+    case ZMK_EV_EVENT_CAPTURED:
+      if (profiled) {
+        finish(type, raised, entered, total_cycles, slowest, slowest_cycles);
+      }
+      return 0;
+    default:
+      goto release;
+    }
+  }
+
+release:
+  if (profiled) {
+    finish(type, raised, entered, total_cycles, slowest, slowest_cycles);
+  }
+  k_free(event);
+  return ret;
+}
+
+static int find_listener(const zmk_event_t *event,
+                         const struct zmk_listener *listener) {
+  uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
+
+  for (int i = 0; i < len; i++) {
+    struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
+
+    if (ev_sub->event_type == event->event && ev_sub->listener == listener) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int __wrap_zmk_event_manager_raise(zmk_event_t *event) {
+  return handle_from(event, 0, true);
+}
+
+int __wrap_zmk_event_manager_raise_after(zmk_event_t *event,
+                                         const struct zmk_listener *listener) {
+  int i = find_listener(event, listener);
+
+  if (i < 0) {
+    LOG_WRN("Unable to find where to raise this after event");
+    return -EINVAL;
+  }
+  return handle_from(event, i + 1, true);
+}
+
+int __wrap_zmk_event_manager_raise_at(zmk_event_t *event,
+                                      const struct zmk_listener *listener) {
+  int i = find_listener(event, listener);
+
+  if (i < 0) {
+    LOG_WRN("Unable to find this listener to raise the event at");
+    return -EINVAL;
+  }
+  return handle_from(event, i, true);
+}
+
+int __wrap_zmk_event_manager_release(zmk_event_t *event) {
+  return handle_from(event, event->last_listener_index + 1, false);
+}
+
+int zmk_template_event_profile_count(void) {
+  return __event_type_end - __event_type_start;
+}
+
+const char *zmk_template_event_profile_name(int index) {
+  if (index < 0 || index >= zmk_template_event_profile_count()) {
+    return NULL;
+  }
+  return __event_type_start[index]->name;
+}
+
+bool zmk_template_event_profile_get(int index,
+                                    struct zmk_template_event_profile *out) {
+  int count = MIN(zmk_template_event_profile_count(), MAX_TYPES);
+
+  if (index < 0 || index >= count) {
+    return false;
+  }
+
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  struct type_profile p = profiles[index];
+  k_spin_unlock(&lock, key);
+
+  out->dispatches = p.dispatches;
+  out->total_ns = zmk_template_cycles_to_ns(p.total_cycles);
+  out->max_ns = zmk_template_cycles_to_ns(p.max_cycles);
+  out->slowest_listener = p.slowest_listener;
+  out->slowest_ns = zmk_template_cycles_to_ns(p.slowest_cycles);
+  return true;
+}
+
+void zmk_template_event_profile_reset(void) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  memset(profiles, 0, sizeof(profiles));
+  k_spin_unlock(&lock, key);
+}
@@ -0,0 +1,71 @@
+/**
+ * Template Feature - Key Event Ring
+ *
+ * Single-producer/single-consumer ring. Zephyr atomics are sequentially
+ * consistent, so publishing `head` after writing the slot (and `tail` after
+ * reading it) is enough to order the slot accesses between both sides.
+ */
+
+#include <zmk/template/event_ring.h>
+
+bool zmk_template_event_ring_put(struct zmk_template_event_ring *ring,
+                                 const struct zmk_template_key_event *ev) {
+  uint32_t head = (uint32_t)atomic_get(&ring->head);
+  uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+
+  if (head - tail > ring->mask) {
+    atomic_inc(&ring->dropped);
+    return false;
+  }
+
+  ring->buf[head & ring->mask] = *ev;
+  atomic_set(&ring->head, (atomic_val_t)(head + 1));
+  return true;
+}
+
+size_t zmk_template_event_ring_get(struct zmk_template_event_ring *ring,
+                                   struct zmk_template_key_event *out,
+                                   size_t max) {
+  uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+  uint32_t head = (uint32_t)atomic_get(&ring->head);
+  size_t count = MIN((size_t)(head - tail), max);
+
+  for (size_t i = 0; i < count; i++) {
+    out[i] = ring->buf[(tail + i) & ring->mask];
+  }
+
+  atomic_set(&ring->tail, (atomic_val_t)(tail + count));
+  return count;
+}
+
+bool zmk_template_event_ring_peek(struct zmk_template_event_ring *ring,
+                                  size_t index,
+                                  struct zmk_template_key_event *out) {
+  uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+  uint32_t head = (uint32_t)atomic_get(&ring->head);
+
+  if (index >= head - tail) {
+    return false;
+  }
+
+  *out = ring->buf[(tail + index) & ring->mask];
+  return true;
+}
+
+void zmk_template_event_ring_skip(struct zmk_template_event_ring *ring,
+                                  size_t count) {
+  uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+  uint32_t head = (uint32_t)atomic_get(&ring->head);
+
+  count = MIN((size_t)(head - tail), count);
+  atomic_set(&ring->tail, (atomic_val_t)(tail + count));
+}
+
+size_t zmk_template_event_ring_size(struct zmk_template_event_ring *ring) {
+  return (uint32_t)atomic_get(&ring->head) - (uint32_t)atomic_get(&ring->tail);
+}
+
+uint32_t zmk_template_event_ring_take_dropped(
+    struct zmk_template_event_ring *ring) {
+  return (uint32_t)atomic_clear(&ring->dropped);
+}
@@ -0,0 +1,9 @@
+/**
+ * Template Feature - Stuck Key Event
+ */
+
+#include <zephyr/kernel.h>
+
+#include <zmk/template/events/stuck_key_changed.h>
+
+ZMK_EVENT_IMPL(zmk_template_stuck_key_changed);
@@ -0,0 +1,111 @@
+/**
+ * Template Feature - Ghost Key Detection
+ *
+ * Keeps one column bitset per matrix row. A press at (r, c) completes a
+ * rectangle with row r2 when r2 has column c pressed and shares at least one
+ * other pressed column with row r, so every row is checked with a couple of
+ * word-wide ANDs and the number of rectangles is a popcount. Rows are 64 bits
+ * wide when the matrix has more than 32 columns; matrices wider than that
+ * are not checked.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/template/ghost.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#if defined(ZMK_TEMPLATE_TRANSFORM_NODE)
+#define GHOST_SUPPORTED (ZMK_TEMPLATE_MATRIX_COLS <= 64)
+#else
+#define GHOST_SUPPORTED 0
+#endif
+
+#if GHOST_SUPPORTED
+
+#if ZMK_TEMPLATE_MATRIX_COLS <= 32
+typedef uint32_t row_t;
+#define ROW_CTZ(bits) __builtin_ctz(bits)
+#define ROW_POPCOUNT(bits) __builtin_popcount(bits)
+#else
+typedef uint64_t row_t;
+#define ROW_CTZ(bits) __builtin_ctzll(bits)
+#define ROW_POPCOUNT(bits) __builtin_popcountll(bits)
+#endif
+
+static row_t row_bits[ZMK_TEMPLATE_MATRIX_ROWS];
+
+static struct zmk_template_ghost_report ghost_report;
+
+bool zmk_template_ghost_record(uint32_t position, bool pressed,
+                               uint32_t timestamp) {
+  uint8_t row, column;
+
+  if (zmk_template_matrix_row_col(position, &row, &column) < 0 ||
+      row >= ZMK_TEMPLATE_MATRIX_ROWS || column >= ZMK_TEMPLATE_MATRIX_COLS) {
+    return false;
+  }
+
+  row_t bit = (row_t)1 << column;
+  if (!pressed) {
+    row_bits[row] &= ~bit;
+    return false;
+  }
+
+  struct zmk_template_ghost_suspect suspect = {0};
+  row_t others = row_bits[row] & ~bit;
+  row_bits[row] |= bit;
+
+  for (uint8_t other = 0; other < ZMK_TEMPLATE_MATRIX_ROWS && others; other++) {
+    if (other == row || !(row_bits[other] & bit)) {
+      continue;
+    }
+
+    row_t shared = row_bits[other] & others;
+    if (shared == 0) {
+      continue;
+    }
+
+    if (suspect.rectangles == 0) {
+      suspect.other_row = other;
+      suspect.other_column = ROW_CTZ(shared);
+    }
+    suspect.rectangles =
+        MIN(suspect.rectangles + ROW_POPCOUNT(shared), UINT8_MAX);
+  }
+
+  if (suspect.rectangles == 0) {
+    return false;
+  }
+
+  suspect.timestamp = timestamp;
+  suspect.position = (uint16_t)position;
+  suspect.row = row;
+  suspect.column = column;
+  ghost_report.suspects[ghost_report.total % ZMK_TEMPLATE_GHOST_HISTORY] =
+      suspect;
+  ghost_report.total++;
+
+  LOG_DBG("position %d ghost rows %d %d columns %d %d", position, row,
+          suspect.other_row, column, suspect.other_column);
+  return true;
+}
+
+const struct zmk_template_ghost_report *zmk_template_ghost_get(void) {
+  return &ghost_report;
+}
+
+#else
+
+bool zmk_template_ghost_record(uint32_t position, bool pressed,
+                               uint32_t timestamp) {
+  return false;
+}
+
+const struct zmk_template_ghost_report *zmk_template_ghost_get(void) {
+  return NULL;
+}
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ * Template Feature - HID Report Statistics
+ *
+ * Transitions are counted from the capture path and taken by the next
+ * report, so a report that follows several transitions counts them as
+ * merged. Reports raised by behaviors without a new transition, e.g. macro
+ * steps or the release half of a tap, count as merging none. The rate is
+ * kept per whole second of uptime, closed by the first report after it.
+ */
+
+#include <zephyr/kernel.h>
+
+#include <zmk/template/cycles.h>
+#include <zmk/template/hid_stats.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static struct k_spinlock lock;
+
+static struct zmk_template_hid_stats stats;
+static atomic_t pending_transitions;
+static uint32_t send_max_cycles;
+
+static int64_t second;
+static uint32_t second_reports;
+
+void zmk_template_hid_stats_transition(void) {
+  atomic_inc(&pending_transitions);
+}
+
+void zmk_template_hid_stats_report(uint32_t cycles, int ret) {
+  uint32_t merged = (uint32_t)atomic_clear(&pending_transitions);
+  int64_t now = k_uptime_get() / MSEC_PER_SEC;
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  if (now != second) {
+    // A gap of more than a second had no reports at all.
+    stats.reports_per_second = now == second + 1 ? second_reports : 0;
+    stats.peak_reports_per_second =
+        MAX(stats.peak_reports_per_second, stats.reports_per_second);
+    second = now;
+    second_reports = 0;
+  }
+  second_reports++;
+
+  stats.reports++;
+  if (ret < 0) {
+    stats.send_errors++;
+  }
+  stats.transitions += merged;
+  stats.merged_histogram[MIN(merged, ZMK_TEMPLATE_HID_MERGED_BUCKETS - 1)]++;
+  stats.send_total_ns += zmk_template_cycles_to_ns(cycles);
+  send_max_cycles = MAX(send_max_cycles, cycles);
+
+  k_spin_unlock(&lock, key);
+}
+
+void zmk_template_hid_stats_get(struct zmk_template_hid_stats *out) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  *out = stats;
+  out->send_max_ns = zmk_template_cycles_to_ns(send_max_cycles);
+
+  k_spin_unlock(&lock, key);
+}
+
+void zmk_template_hid_stats_reset(void) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  stats = (struct zmk_template_hid_stats){0};
+  send_max_cycles = 0;
+  second_reports = 0;
+  atomic_clear(&pending_transitions);
+
+  k_spin_unlock(&lock, key);
+}
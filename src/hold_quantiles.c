@@ -0,0 +1,235 @@
+/**
+ * Template Feature - Hold Duration Quantiles
+ *
+ * Integer-only extended P² (Raatikainen's generalisation of Jain and
+ * Chlamtac's algorithm to several quantiles). Marker quantiles are kept in
+ * units of 1/10000.
+ */
+
+#include <zephyr/kernel.h>
+
+#include <zmk/template/hold_quantiles.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define QUANTILE_ONE 10000U
+
+static const uint16_t marker_quantiles[ZMK_TEMPLATE_HOLD_MARKERS] = {
+    0, 2500, 5000, 7250, 9500, 9700, 9900, 9950, QUANTILE_ONE,
+};
+
+// Marker holding each reported quantile once warmed up
+static const uint8_t quantile_markers[ZMK_TEMPLATE_HOLD_QUANTILE_COUNT] = {
+    [ZMK_TEMPLATE_HOLD_P50] = 2,
+    [ZMK_TEMPLATE_HOLD_P95] = 4,
+    [ZMK_TEMPLATE_HOLD_P99] = 6,
+};
+
+static struct zmk_template_hold_estimator estimators[ZMK_TEMPLATE_KEY_COUNT];
+
+static uint32_t pressed_at[ZMK_TEMPLATE_KEY_COUNT];
+static ATOMIC_DEFINE(held, ZMK_TEMPLATE_KEY_COUNT);
+
+static void insert_sorted(struct zmk_template_hold_estimator *est,
+                          uint16_t x) {
+  int i = est->count;
+
+  while (i > 0 && est->heights[i - 1] > x) {
+    est->heights[i] = est->heights[i - 1];
+    i--;
+  }
+  est->heights[i] = x;
+  est->count++;
+
+  if (est->count == ZMK_TEMPLATE_HOLD_MARKERS) {
+    for (int m = 0; m < ZMK_TEMPLATE_HOLD_MARKERS; m++) {
+      est->positions[m] = m + 1;
+    }
+  }
+}
+
+/**
+ * Piecewise parabolic prediction of marker `i` moved by `d`, evaluated over
+ * a common denominator. Marker positions are bounded by UINT16_MAX, so the
+ * products fit in 64 bits.
+ */
+static int32_t parabolic(const struct zmk_template_hold_estimator *est, int i,
+                         int d) {
+  int64_t n0 = est->positions[i - 1];
+  int64_t n1 = est->positions[i];
+  int64_t n2 = est->positions[i + 1];
+  int64_t q0 = est->heights[i - 1];
+  int64_t q1 = est->heights[i];
+  int64_t q2 = est->heights[i + 1];
+
+  int64_t num = (n1 - n0 + d) * (q2 - q1) * (n1 - n0) +
+                (n2 - n1 - d) * (q1 - q0) * (n2 - n1);
+  int64_t den = (n2 - n0) * (n2 - n1) * (n1 - n0);
+
+  return (int32_t)(q1 + d * num / den);
+}
+
+static int32_t linear(const struct zmk_template_hold_estimator *est, int i,
+                      int d) {
+  int32_t q1 = est->heights[i];
+  int32_t q2 = est->heights[i + d];
+  int32_t dn = (int32_t)est->positions[i + d] - est->positions[i];
+
+  return q1 + d * (q2 - q1) / dn;
+}
+
+/**
+ * Halve all marker positions, keeping them strictly increasing, once the
+ * count is about to overflow.
+ */
+static void rescale(struct zmk_template_hold_estimator *est) {
+  est->positions[0] = 1;
+  for (int m = 1; m < ZMK_TEMPLATE_HOLD_MARKERS; m++) {
+    est->positions[m] =
+        MAX(est->positions[m] / 2, est->positions[m - 1] + 1);
+  }
+  est->count = est->positions[ZMK_TEMPLATE_HOLD_MARKERS - 1];
+}
+
+static void update(struct zmk_template_hold_estimator *est, uint16_t x) {
+  const int last = ZMK_TEMPLATE_HOLD_MARKERS - 1;
+  int cell;
+
+  if (est->count < ZMK_TEMPLATE_HOLD_MARKERS) {
+    insert_sorted(est, x);
+    return;
+  }
+
+  if (est->count == UINT16_MAX) {
+    rescale(est);
+  }
+
+  // Find the cell holding x, extending the extremes if needed
+  if (x < est->heights[0]) {
+    est->heights[0] = x;
+    cell = 0;
+  } else if (x >= est->heights[last]) {
+    est->heights[last] = x;
+    cell = last - 1;
+  } else {
+    cell = 0;
+    while (x >= est->heights[cell + 1]) {
+      cell++;
+    }
+  }
+
+  for (int m = cell + 1; m <= last; m++) {
+    est->positions[m]++;
+  }
+  est->count++;
+
+  for (int m = 1; m < last; m++) {
+    // Ideal position minus the actual one, times QUANTILE_ONE
+    uint32_t ideal = QUANTILE_ONE + (est->count - 1U) * marker_quantiles[m];
+    int32_t drift =
+        (int32_t)ideal - (int32_t)(est->positions[m] * QUANTILE_ONE);
+    int d;
+
+    if (drift >= (int32_t)QUANTILE_ONE &&
+        est->positions[m + 1] - est->positions[m] > 1) {
+      d = 1;
+    } else if (drift <= -(int32_t)QUANTILE_ONE &&
+               est->positions[m] - est->positions[m - 1] > 1) {
+      d = -1;
+    } else {
+      continue;
+    }
+
+    int32_t height = parabolic(est, m, d);
+    if (height <= est->heights[m - 1] || height >= est->heights[m + 1]) {
+      height = linear(est, m, d);
+    }
+    est->heights[m] = (uint16_t)height;
+    est->positions[m] += d;
+  }
+}
+
+void zmk_template_hold_quantiles_record(uint32_t position, bool pressed,
+                                        uint32_t timestamp) {
+  if (position >= ZMK_TEMPLATE_KEY_COUNT) {
+    return;
+  }
+
+  if (pressed) {
+    pressed_at[position] = timestamp;
+    atomic_set_bit(held, position);
+    return;
+  }
+
+  if (!atomic_test_and_clear_bit(held, position)) {
+    return;
+  }
+
+  uint32_t hold_us = k_cyc_to_us_floor32(timestamp - pressed_at[position]);
+  uint16_t units = MIN(hold_us / ZMK_TEMPLATE_HOLD_UNIT_US, UINT16_MAX);
+
+  update(&estimators[position], units);
+
+  LOG_DBG("position %d hold %d ms p50 %d ms p95 %d ms", position,
+          hold_us / 1000,
+          zmk_template_hold_quantile_us(position, ZMK_TEMPLATE_HOLD_P50) /
+              1000,
+          zmk_template_hold_quantile_us(position, ZMK_TEMPLATE_HOLD_P95) /
+              1000);
+}
+
+void zmk_template_hold_quantiles_forget(uint32_t position) {
+  if (position < ZMK_TEMPLATE_KEY_COUNT) {
+    atomic_clear_bit(held, position);
+  }
+}
+
+uint32_t zmk_template_hold_quantiles_samples(uint32_t position) {
+  if (position >= ZMK_TEMPLATE_KEY_COUNT) {
+    return 0;
+  }
+  return estimators[position].count;
+}
+
+uint32_t zmk_template_hold_quantile_us(uint32_t position,
+                                       enum zmk_template_hold_quantile q) {
+  if (position >= ZMK_TEMPLATE_KEY_COUNT ||
+      q >= ZMK_TEMPLATE_HOLD_QUANTILE_COUNT) {
+    return 0;
+  }
+
+  const struct zmk_template_hold_estimator *est = &estimators[position];
+  uint16_t count = est->count;
+  int marker = quantile_markers[q];
+
+  if (count == 0) {
+    return 0;
+  }
+
+  // Until all markers are placed the sorted observations are exact
+  if (count < ZMK_TEMPLATE_HOLD_MARKERS) {
+    marker = ((count - 1) * marker_quantiles[marker] + QUANTILE_ONE / 2) /
+             QUANTILE_ONE;
+    return est->heights[marker] * ZMK_TEMPLATE_HOLD_UNIT_US;
+  }
+
+  // Markers move at most one rank per observation, so they lag behind their
+  // ideal ranks for a while after warming up. Interpolate between the
+  // markers around the ideal rank of the quantile instead.
+  uint32_t ideal = QUANTILE_ONE + (count - 1U) * marker_quantiles[marker];
+  int m = 0;
+
+  while (m < ZMK_TEMPLATE_HOLD_MARKERS - 2 &&
+         est->positions[m + 1] * QUANTILE_ONE <= ideal) {
+    m++;
+  }
+
+  int64_t q0 = est->heights[m];
+  int64_t q1 = est->heights[m + 1];
+  int64_t offset = (int64_t)ideal - est->positions[m] * QUANTILE_ONE;
+  int64_t span = (est->positions[m + 1] - est->positions[m]) * QUANTILE_ONE;
+
+  return (uint32_t)(q0 + (q1 - q0) * offset / span) *
+         ZMK_TEMPLATE_HOLD_UNIT_US;
+}
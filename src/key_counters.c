@@ -0,0 +1,34 @@
+/**
+ * Template Feature - Per-Key Actuation Counters
+ */
+
+#include <zephyr/kernel.h>
+
+#include <zmk/template/key_counters.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static struct zmk_template_key_counters key_counters;
+
+void zmk_template_key_counters_record(uint32_t position, bool pressed,
+                                      uint32_t generation) {
+  if (position >= ZMK_TEMPLATE_KEY_COUNT) {
+    return;
+  }
+
+  if (pressed) {
+    zmk_template_counter_inc(&key_counters.presses[position]);
+  } else {
+    zmk_template_counter_inc(&key_counters.releases[position]);
+  }
+  key_counters.modified[position] = generation;
+
+  LOG_DBG("position %d presses %d releases %d", position,
+          zmk_template_counter_read(&key_counters.presses[position]),
+          zmk_template_counter_read(&key_counters.releases[position]));
+}
+
+const struct zmk_template_key_counters *zmk_template_key_counters_get(void) {
+  return &key_counters;
+}
@@ -0,0 +1,323 @@
+/**
+ * Template Feature - Kscan Diagnostics Tap
+ *
+ * Transparent kscan driver wrapping the real kscan device. Each transition is
+ * captured for diagnostics and then handed to the upstream callback with the
+ * original arguments, so nothing is copied or queued on the way through. The
+ * time spent in the tap itself is measured for every event.
+ *
+ * With `debounce-press-ms`/`debounce-release-ms` set, the wrapped kscan is
+ * expected to report raw transitions and the tap debounces them instead,
+ * counting what it rejects. A transition is accepted once the raw state held
+ * still for the debounce time; one delayable work item per tap, scheduled
+ * for the earliest deadline, checks the keys in a burst.
+ */
+
+#define DT_DRV_COMPAT zmk_kscan_diagnostics_tap
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/kscan.h>
+#include <zephyr/kernel.h>
+
+#include <zmk/template/analysis.h>
+#include <zmk/template/capture.h>
+#include <zmk/template/cycles.h>
+#include <zmk/template/kscan_tap.h>
+#include <zmk/template/matrix.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+// Debounce state of a key position
+struct kscan_tap_key {
+  // Cycle timestamps of the first and the last raw transition of the burst
+  uint32_t burst_start;
+  uint32_t changed_at;
+  uint8_t row;
+  uint8_t column;
+  // Raw transitions in the burst, saturating
+  uint8_t transitions;
+  bool raw : 1;
+  bool debounced : 1;
+  bool pending : 1;
+};
+
+struct kscan_tap_config {
+  const struct device *kscan;
+  kscan_callback_t tap_callback;
+  uint32_t debounce_press_ms;
+  uint32_t debounce_release_ms;
+  // Debounce state per key position, NULL unless the tap debounces
+  struct kscan_tap_key *keys;
+};
+
+struct kscan_tap_data {
+  const struct device *dev;
+  kscan_callback_t callback;
+  volatile uint32_t events;
+  volatile uint32_t unmapped;
+  volatile uint64_t overhead_total;
+  volatile uint32_t overhead_max;
+
+  struct k_spinlock lock;
+  struct k_work_delayable debounce_work;
+  // Cycle timestamp the debounce work is scheduled for, if scheduled
+  uint32_t deadline;
+  bool scheduled;
+};
+
+static void kscan_tap_forward(const struct device *dev, uint32_t row,
+                              uint32_t column, bool pressed) {
+  struct kscan_tap_data *data = dev->data;
+  zmk_template_cycles_t start = zmk_template_cycles_now();
+
+  int32_t position = zmk_template_matrix_position(row, column);
+  if (position >= 0) {
+    zmk_template_capture_key_event(position, pressed);
+  } else {
+    data->unmapped++;
+  }
+
+  uint32_t overhead = zmk_template_cycles_since(start);
+  data->overhead_total += overhead;
+  if (overhead > data->overhead_max) {
+    data->overhead_max = overhead;
+  }
+  data->events++;
+
+  if (data->callback) {
+    data->callback(dev, row, column, pressed);
+  }
+}
+
+static bool kscan_tap_debounces(const struct kscan_tap_config *config) {
+  return config->debounce_press_ms > 0 || config->debounce_release_ms > 0;
+}
+
+static uint32_t kscan_tap_debounce_cycles(const struct kscan_tap_config *config,
+                                          bool pressed) {
+  return k_ms_to_cyc_ceil32(pressed ? config->debounce_press_ms
+                                    : config->debounce_release_ms);
+}
+
+// Must be called with the lock held, so the recorded deadline and the
+// scheduled work change together and the work is only ever moved earlier.
+static void kscan_tap_schedule_locked(struct kscan_tap_data *data,
+                                      uint32_t deadline, uint32_t now) {
+  if (data->scheduled && (int32_t)(deadline - data->deadline) >= 0) {
+    return;
+  }
+  data->scheduled = true;
+  data->deadline = deadline;
+  k_work_reschedule(&data->debounce_work, K_CYC(deadline - now));
+}
+
+static void kscan_tap_debounce_scan(struct k_work *work) {
+  struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+  struct kscan_tap_data *data =
+      CONTAINER_OF(dwork, struct kscan_tap_data, debounce_work);
+  const struct device *dev = data->dev;
+  const struct kscan_tap_config *config = dev->config;
+  uint8_t accepted[DIV_ROUND_UP(ZMK_TEMPLATE_KEY_COUNT, 8)] = {0};
+  uint32_t now = k_cycle_get_32();
+  uint32_t next = 0;
+  bool pending = false;
+
+  k_spinlock_key_t key = k_spin_lock(&data->lock);
+  data->scheduled = false;
+
+  for (int pos = 0; pos < ZMK_TEMPLATE_KEY_COUNT; pos++) {
+    struct kscan_tap_key *k = &config->keys[pos];
+
+    if (!k->pending) {
+      continue;
+    }
+
+    uint32_t deadline =
+        k->changed_at + kscan_tap_debounce_cycles(config, k->raw);
+    if ((int32_t)(deadline - now) > 0) {
+      if (!pending || (int32_t)(deadline - next) < 0) {
+        next = deadline;
+        pending = true;
+      }
+      continue;
+    }
+
+    // A burst that ends where it started is a glitch and rejected entirely.
+    // Only rejections are queued; the analysis keeps the statistics.
+    bool accept = k->raw != k->debounced;
+    uint32_t rejected = k->transitions - (accept ? 1 : 0);
+    if (rejected > 0) {
+      zmk_template_analysis_submit_burst(
+          pos, !k->debounced, rejected,
+          k_cyc_to_us_floor32(k->changed_at - k->burst_start));
+    }
+    k->pending = false;
+    if (accept) {
+      k->debounced = k->raw;
+      accepted[pos / 8] |= BIT(pos % 8);
+    }
+  }
+
+  if (pending) {
+    kscan_tap_schedule_locked(data, next, now);
+  }
+  k_spin_unlock(&data->lock, key);
+
+  // Only this work changes the debounced state, so the accepted keys can be
+  // forwarded without the lock.
+  for (int pos = 0; pos < ZMK_TEMPLATE_KEY_COUNT; pos++) {
+    if (accepted[pos / 8] & BIT(pos % 8)) {
+      const struct kscan_tap_key *k = &config->keys[pos];
+      kscan_tap_forward(dev, k->row, k->column, k->debounced);
+    }
+  }
+}
+
+static void kscan_tap_raw(const struct device *dev, uint32_t row,
+                          uint32_t column, bool pressed) {
+  const struct kscan_tap_config *config = dev->config;
+  struct kscan_tap_data *data = dev->data;
+
+  int32_t position = zmk_template_matrix_position(row, column);
+  if (IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_SHADOW_DEBOUNCE) &&
+      position >= 0) {
+    zmk_template_analysis_submit_raw(position, pressed);
+  }
+
+  if (!kscan_tap_debounces(config) || position < 0) {
+    kscan_tap_forward(dev, row, column, pressed);
+    return;
+  }
+
+  uint32_t now = k_cycle_get_32();
+  uint32_t delay = kscan_tap_debounce_cycles(config, pressed);
+  k_spinlock_key_t key = k_spin_lock(&data->lock);
+  struct kscan_tap_key *k = &config->keys[position];
+
+  if (k->pending || pressed != k->debounced) {
+    if (!k->pending) {
+      k->pending = true;
+      k->burst_start = now;
+      k->transitions = 0;
+      k->row = row;
+      k->column = column;
+    }
+    k->raw = pressed;
+    k->changed_at = now;
+    if (k->transitions < UINT8_MAX) {
+      k->transitions++;
+    }
+    kscan_tap_schedule_locked(data, now + delay, now);
+  }
+
+  k_spin_unlock(&data->lock, key);
+}
+
+static int kscan_tap_configure(const struct device *dev,
+                               kscan_callback_t callback) {
+  const struct kscan_tap_config *config = dev->config;
+  struct kscan_tap_data *data = dev->data;
+
+  if (!device_is_ready(config->kscan)) {
+    LOG_ERR("Wrapped kscan device %s is not ready", config->kscan->name);
+    return -ENODEV;
+  }
+
+  data->callback = callback;
+  return kscan_config(config->kscan, config->tap_callback);
+}
+
+static int kscan_tap_enable_callback(const struct device *dev) {
+  const struct kscan_tap_config *config = dev->config;
+
+  return kscan_enable_callback(config->kscan);
+}
+
+static int kscan_tap_disable_callback(const struct device *dev) {
+  const struct kscan_tap_config *config = dev->config;
+
+  return kscan_disable_callback(config->kscan);
+}
+
+static int kscan_tap_init(const struct device *dev) {
+  struct kscan_tap_data *data = dev->data;
+
+  data->dev = dev;
+  k_work_init_delayable(&data->debounce_work, kscan_tap_debounce_scan);
+
+  if (zmk_template_matrix_position(0, 0) == -ENOTSUP) {
+    LOG_WRN("No matrix transform found, %s only counts transitions",
+            dev->name);
+  }
+  return 0;
+}
+
+static const struct kscan_driver_api kscan_tap_api = {
+    .config = kscan_tap_configure,
+    .enable_callback = kscan_tap_enable_callback,
+    .disable_callback = kscan_tap_disable_callback,
+};
+
+// Only instances with a debounce time get the per-key debounce state.
+#define KSCAN_TAP_DEBOUNCES(n)                                                 \
+  UTIL_OR(DT_INST_NODE_HAS_PROP(n, debounce_press_ms),                         \
+          DT_INST_NODE_HAS_PROP(n, debounce_release_ms))
+
+#define KSCAN_TAP_INST(n)                                                      \
+  static void kscan_tap_callback_##n(const struct device *kscan, uint32_t row, \
+                                     uint32_t column, bool pressed) {          \
+    kscan_tap_raw(DEVICE_DT_INST_GET(n), row, column, pressed);                \
+  }                                                                            \
+                                                                               \
+  static struct kscan_tap_data kscan_tap_data_##n;                             \
+  COND_CODE_1(KSCAN_TAP_DEBOUNCES(n),                                          \
+              (static struct kscan_tap_key                                     \
+                   kscan_tap_keys_##n[ZMK_TEMPLATE_KEY_COUNT];),               \
+              ())                                                              \
+                                                                               \
+  static const struct kscan_tap_config kscan_tap_config_##n = {                \
+      .kscan = DEVICE_DT_GET(DT_INST_PHANDLE(n, kscan)),                       \
+      .tap_callback = kscan_tap_callback_##n,                                  \
+      .debounce_press_ms = DT_INST_PROP_OR(n, debounce_press_ms, 0),           \
+      .debounce_release_ms = DT_INST_PROP_OR(n, debounce_release_ms, 0),       \
+      .keys = COND_CODE_1(KSCAN_TAP_DEBOUNCES(n), (kscan_tap_keys_##n),        \
+                          (NULL)),                                             \
+  };                                                                           \
+                                                                               \
+  DEVICE_DT_INST_DEFINE(n, kscan_tap_init, NULL, &kscan_tap_data_##n,          \
+                        &kscan_tap_config_##n, POST_KERNEL,                    \
+                        CONFIG_KSCAN_INIT_PRIORITY, &kscan_tap_api);
+
+DT_INST_FOREACH_STATUS_OKAY(KSCAN_TAP_INST)
+
+#define KSCAN_TAP_ADD_STATS(n)                                                 \
+  kscan_tap_add_stats(DEVICE_DT_INST_GET(n), stats, &overhead_max);
+
+static void kscan_tap_add_stats(const struct device *dev,
+                                struct zmk_template_kscan_tap_stats *stats,
+                                uint32_t *overhead_max) {
+  struct kscan_tap_data *data = dev->data;
+  uint32_t events;
+  uint64_t overhead_total;
+
+  // The tap may fire from an interrupt while we read the 64-bit total.
+  do {
+    events = data->events;
+    overhead_total = data->overhead_total;
+  } while (events != data->events);
+
+  stats->events += events;
+  stats->unmapped += data->unmapped;
+  stats->overhead_total_ns += zmk_template_cycles_to_ns(overhead_total);
+  *overhead_max = MAX(*overhead_max, data->overhead_max);
+}
+
+void zmk_template_kscan_tap_get_stats(
+    struct zmk_template_kscan_tap_stats *stats) {
+  uint32_t overhead_max = 0;
+
+  *stats = (struct zmk_template_kscan_tap_stats){0};
+  DT_INST_FOREACH_STATUS_OKAY(KSCAN_TAP_ADD_STATS)
+  stats->overhead_max_ns = zmk_template_cycles_to_ns(overhead_max);
+}
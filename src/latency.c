@@ -0,0 +1,148 @@
+/**
+ * Template Feature - Keypress Pipeline Latency
+ *
+ * All stages after the kscan callback run on the system work queue, one
+ * keypress at a time, so a single in-flight chain is tracked. Keycodes and
+ * reports are attributed to the most recent position event. Timestamps use
+ * zmk_template_cycles_now(), since the system cycle counter may tick as
+ * slowly as every 30 us.
+ */
+
+#include <zephyr/kernel.h>
+
+#include <zmk/event_manager.h>
+#include <zmk/events/keycode_state_changed.h>
+#include <zmk/events/position_state_changed.h>
+#include <zmk/template/histogram.h>
+#include <zmk/template/latency.h>
+#include <zmk/template/matrix.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static struct zmk_template_latency_histogram
+    histograms[ZMK_TEMPLATE_LATENCY_STAGE_COUNT];
+
+static zmk_template_cycles_t kscan_timestamp[ZMK_TEMPLATE_KEY_COUNT];
+static ATOMIC_DEFINE(kscan_valid, ZMK_TEMPLATE_KEY_COUNT);
+
+static struct {
+  zmk_template_cycles_t start;
+  zmk_template_cycles_t position;
+  zmk_template_cycles_t keycode;
+  bool behavior_pending;
+  bool endpoint_pending;
+  bool total_pending;
+} chain;
+
+void zmk_template_latency_histogram_add(
+    struct zmk_template_latency_histogram *histogram, uint32_t us) {
+  histogram->buckets[zmk_template_log2_bucket(
+      us, ZMK_TEMPLATE_LATENCY_MIN_SHIFT, ZMK_TEMPLATE_LATENCY_BUCKETS)]++;
+  histogram->max_us = MAX(histogram->max_us, us);
+  histogram->count++;
+}
+
+static void record_stage(enum zmk_template_latency_stage stage,
+                         zmk_template_cycles_t from, zmk_template_cycles_t to) {
+  uint32_t us =
+      zmk_template_cycles_to_ns(zmk_template_cycles_between(from, to)) / 1000;
+
+  zmk_template_latency_histogram_add(&histograms[stage], us);
+  LOG_DBG("stage %d took %d us", stage, us);
+}
+
+void zmk_template_latency_kscan(uint32_t position,
+                                zmk_template_cycles_t timestamp) {
+  if (position >= ZMK_TEMPLATE_KEY_COUNT) {
+    return;
+  }
+
+  kscan_timestamp[position] = timestamp;
+  atomic_set_bit(kscan_valid, position);
+}
+
+void zmk_template_latency_report_sent(void) {
+  zmk_template_cycles_t now = zmk_template_cycles_now();
+
+  if (chain.endpoint_pending) {
+    record_stage(ZMK_TEMPLATE_LATENCY_STAGE_ENDPOINT, chain.keycode, now);
+    chain.endpoint_pending = false;
+  }
+  if (chain.total_pending) {
+    record_stage(ZMK_TEMPLATE_LATENCY_STAGE_TOTAL, chain.start, now);
+    chain.total_pending = false;
+  }
+}
+
+static int position_state_changed_listener(const zmk_event_t *eh) {
+  const struct zmk_position_state_changed *ev =
+      as_zmk_position_state_changed(eh);
+  zmk_template_cycles_t now = zmk_template_cycles_now();
+
+  if (ev->source != ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL ||
+      ev->position >= ZMK_TEMPLATE_KEY_COUNT) {
+    return ZMK_EV_EVENT_BUBBLE;
+  }
+
+  chain.start = now;
+  if (atomic_test_and_clear_bit(kscan_valid, ev->position)) {
+    chain.start = kscan_timestamp[ev->position];
+    record_stage(ZMK_TEMPLATE_LATENCY_STAGE_SCAN, chain.start, now);
+  }
+  chain.position = now;
+  chain.behavior_pending = true;
+  chain.total_pending = true;
+  return ZMK_EV_EVENT_BUBBLE;
+}
+
+static int keycode_state_changed_listener(const zmk_event_t *eh) {
+  zmk_template_cycles_t now = zmk_template_cycles_now();
+
+  if (chain.behavior_pending) {
+    record_stage(ZMK_TEMPLATE_LATENCY_STAGE_BEHAVIOR, chain.position, now);
+    chain.behavior_pending = false;
+  }
+  chain.keycode = now;
+  chain.endpoint_pending = true;
+  return ZMK_EV_EVENT_BUBBLE;
+}
+
+static int template_latency_listener(const zmk_event_t *eh) {
+  if (as_zmk_position_state_changed(eh) != NULL) {
+    return position_state_changed_listener(eh);
+  }
+  if (as_zmk_keycode_state_changed(eh) != NULL) {
+    return keycode_state_changed_listener(eh);
+  }
+  return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(template_latency, template_latency_listener);
+ZMK_SUBSCRIPTION(template_latency, zmk_position_state_changed);
+ZMK_SUBSCRIPTION(template_latency, zmk_keycode_state_changed);
+
+const struct zmk_template_latency_histogram *
+zmk_template_latency_get(enum zmk_template_latency_stage stage) {
+  return &histograms[stage];
+}
+
+uint32_t zmk_template_latency_percentile_us(
+    const struct zmk_template_latency_histogram *histogram, uint8_t percent) {
+  uint64_t target = (uint64_t)histogram->count * percent;
+  uint64_t seen = 0;
+
+  if (histogram->count == 0) {
+    return 0;
+  }
+
+  for (int b = 0; b < ZMK_TEMPLATE_LATENCY_BUCKETS - 1; b++) {
+    seen += (uint64_t)histogram->buckets[b] * 100;
+    if (seen >= target) {
+      uint32_t upper =
+          zmk_template_log2_bucket_floor(b + 1, ZMK_TEMPLATE_LATENCY_MIN_SHIFT);
+      return MIN(upper, histogram->max_us);
+    }
+  }
+  return histogram->max_us;
+}
@@ -0,0 +1,72 @@
+/**
+ * Template Feature - Matrix Geometry
+ *
+ * The row/column to position lookup and its inverse are generated from the
+ * transform `map` property at compile time and live in flash.
+ */
+
+#include <errno.h>
+
+#include <zephyr/kernel.h>
+
+#include <dt-bindings/zmk/matrix_transform.h>
+#include <zmk/template/matrix.h>
+
+#if defined(ZMK_TEMPLATE_TRANSFORM_NODE)
+
+#define ROW_OFFSET DT_PROP_OR(ZMK_TEMPLATE_TRANSFORM_NODE, row_offset, 0)
+#define COL_OFFSET DT_PROP_OR(ZMK_TEMPLATE_TRANSFORM_NODE, col_offset, 0)
+
+BUILD_ASSERT(DT_PROP_LEN(ZMK_TEMPLATE_TRANSFORM_NODE, map) < UINT16_MAX,
+             "Too many keys in the matrix transform");
+
+// Entries hold position + 1 so that unassigned row/columns stay zero.
+#define LOOKUP_ENTRY(node_id, prop, idx)                                       \
+  [KT_ROW(DT_PROP_BY_IDX(node_id, prop, idx)) * ZMK_TEMPLATE_MATRIX_COLS +     \
+   KT_COL(DT_PROP_BY_IDX(node_id, prop, idx))] = (idx) + 1,
+
+static const uint16_t
+    position_lookup[ZMK_TEMPLATE_MATRIX_ROWS * ZMK_TEMPLATE_MATRIX_COLS] = {
+        DT_FOREACH_PROP_ELEM(ZMK_TEMPLATE_TRANSFORM_NODE, map, LOOKUP_ENTRY)};
+
+// Entries hold the RC() value of each position.
+#define RC_ENTRY(node_id, prop, idx) DT_PROP_BY_IDX(node_id, prop, idx),
+
+static const uint16_t position_rc[ZMK_TEMPLATE_KEY_COUNT] = {
+    DT_FOREACH_PROP_ELEM(ZMK_TEMPLATE_TRANSFORM_NODE, map, RC_ENTRY)};
+
+int32_t zmk_template_matrix_position(uint32_t row, uint32_t column) {
+  row += ROW_OFFSET;
+  column += COL_OFFSET;
+
+  if (row >= ZMK_TEMPLATE_MATRIX_ROWS || column >= ZMK_TEMPLATE_MATRIX_COLS) {
+    return -EINVAL;
+  }
+
+  uint16_t entry = position_lookup[row * ZMK_TEMPLATE_MATRIX_COLS + column];
+  return entry == 0 ? -ENOENT : (int32_t)entry - 1;
+}
+
+int zmk_template_matrix_row_col(uint32_t position, uint8_t *row,
+                                uint8_t *column) {
+  if (position >= ZMK_TEMPLATE_KEY_COUNT) {
+    return -EINVAL;
+  }
+
+  *row = KT_ROW(position_rc[position]);
+  *column = KT_COL(position_rc[position]);
+  return 0;
+}
+
+#else
+
+int32_t zmk_template_matrix_position(uint32_t row, uint32_t column) {
+  return -ENOTSUP;
+}
+
+int zmk_template_matrix_row_col(uint32_t position, uint8_t *row,
+                                uint8_t *column) {
+  return -ENOTSUP;
+}
+
+#endif
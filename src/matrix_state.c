@@ -0,0 +1,37 @@
+/**
+ * Template Feature - Instantaneous Matrix State
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include <zmk/template/matrix_state.h>
+
+static ATOMIC_DEFINE(pressed_keys, ZMK_TEMPLATE_KEY_COUNT);
+
+void zmk_template_matrix_state_record(uint32_t position, bool pressed) {
+  if (position >= ZMK_TEMPLATE_KEY_COUNT) {
+    return;
+  }
+
+  atomic_set_bit_to(pressed_keys, position, pressed);
+}
+
+size_t zmk_template_matrix_state_snapshot(uint8_t *out, size_t len) {
+  size_t count = MIN(len, (size_t)ZMK_TEMPLATE_MATRIX_STATE_BYTES);
+
+  // Atomic bitmaps are little endian bit order within each word, so the
+  // bytes of a word are emitted from least to most significant.
+  for (size_t word = 0; word * sizeof(atomic_val_t) < count; word++) {
+    atomic_val_t bits = atomic_get(&pressed_keys[word]);
+
+    for (size_t i = 0; i < sizeof(atomic_val_t); i++) {
+      size_t index = word * sizeof(atomic_val_t) + i;
+      if (index >= count) {
+        break;
+      }
+      out[index] = (uint8_t)(bits >> (8 * i));
+    }
+  }
+  return count;
+}
@@ -0,0 +1,118 @@
+/**
+ * Template Feature - Scan Timing Probe
+ *
+ * The interval mean and variance use Welford's algorithm in fixed point: the
+ * mean is kept in 1/256 us and the sum of squared deviations in 1/65536 us².
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+
+#include <zmk/template/histogram.h>
+#include <zmk/template/scan_timing.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define PERIOD_MS ZMK_TEMPLATE_SCAN_TIMING_PERIOD_MS
+
+BUILD_ASSERT(ZMK_TEMPLATE_KSCAN_POLL_PERIOD_MS == 0 ||
+                 PERIOD_MS == ZMK_TEMPLATE_KSCAN_POLL_PERIOD_MS,
+             "CONFIG_ZMK_TEMPLATE_FEATURE_SCAN_TIMING_PERIOD_MS does not "
+             "match the poll-period-ms of the kscan");
+
+#if ZMK_TEMPLATE_KSCAN_POLL_PERIOD_MS == 0 &&                                  \
+    CONFIG_ZMK_TEMPLATE_FEATURE_SCAN_TIMING_PERIOD_MS == 0
+// Probing every 10 ms
+#warning "The kscan has no poll-period-ms, set SCAN_TIMING_PERIOD_MS"
+#endif
+#define MEAN_SHIFT 8
+
+static struct k_spinlock lock;
+
+static struct zmk_template_scan_timing timing;
+static int64_t mean_q;
+static uint64_t m2_q;
+static int64_t started_at;
+
+// Kernel ticks of the next deadline and of the last run
+static int64_t deadline;
+static int64_t last_run;
+
+static void record_interval(uint32_t interval_us) {
+  uint32_t n = ++timing.scans;
+  int64_t x = (int64_t)interval_us << MEAN_SHIFT;
+  int64_t delta = x - mean_q;
+
+  mean_q += delta / n;
+  uint64_t step = (uint64_t)(delta * (x - mean_q));
+  m2_q = step > UINT64_MAX - m2_q ? UINT64_MAX : m2_q + step;
+
+  timing.min_interval_us =
+      n == 1 ? interval_us : MIN(timing.min_interval_us, interval_us);
+  timing.max_interval_us = MAX(timing.max_interval_us, interval_us);
+}
+
+static void record_late(uint32_t late_us) {
+  timing.max_late_us = MAX(timing.max_late_us, late_us);
+  timing.late_histogram[zmk_template_log2_bucket(
+      late_us, ZMK_TEMPLATE_SCAN_TIMING_MIN_SHIFT,
+      ZMK_TEMPLATE_SCAN_TIMING_BUCKETS)]++;
+}
+
+static void scan_probe(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(scan_probe_work, scan_probe);
+
+static void scan_probe(struct k_work *work) {
+  int64_t now = k_uptime_ticks();
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  if (last_run != 0) {
+    record_interval(k_ticks_to_us_floor64(now - last_run));
+  }
+  record_late(k_ticks_to_us_floor64(MAX(now - deadline, 0)));
+  last_run = now;
+
+  k_spin_unlock(&lock, key);
+
+  // Like the kscan drivers, catch up on missed deadlines instead of
+  // skipping them.
+  deadline += k_ms_to_ticks_ceil64(PERIOD_MS);
+  k_work_reschedule(&scan_probe_work, K_TIMEOUT_ABS_TICKS(deadline));
+}
+
+void zmk_template_scan_timing_get(struct zmk_template_scan_timing *out) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  *out = timing;
+  out->elapsed_ms = k_uptime_get() - started_at;
+  out->mean_interval_us = mean_q >> MEAN_SHIFT;
+  if (timing.scans > 1) {
+    out->interval_variance_us2 =
+        (m2_q / (timing.scans - 1)) >> (2 * MEAN_SHIFT);
+  }
+
+  k_spin_unlock(&lock, key);
+}
+
+void zmk_template_scan_timing_reset(void) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  timing = (struct zmk_template_scan_timing){0};
+  mean_q = 0;
+  m2_q = 0;
+  last_run = 0;
+  started_at = k_uptime_get();
+
+  k_spin_unlock(&lock, key);
+}
+
+static int template_scan_timing_init(void) {
+  started_at = k_uptime_get();
+  deadline = k_uptime_ticks() + k_ms_to_ticks_ceil64(PERIOD_MS);
+  k_work_reschedule(&scan_probe_work, K_TIMEOUT_ABS_TICKS(deadline));
+  return 0;
+}
+
+SYS_INIT(template_scan_timing_init, APPLICATION,
+         CONFIG_APPLICATION_INIT_PRIORITY);
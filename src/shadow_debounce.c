@@ -0,0 +1,217 @@
+/**
+ * Template Feature - Shadow Debouncers
+ *
+ * The debouncers are evaluated lazily: an emission that becomes due while
+ * the raw state of a key holds still is only resolved on the next raw
+ * transition of that key, or when the statistics are read, and is accounted
+ * at the time it would have happened. No timers are needed.
+ *
+ * Times are kernel ticks truncated to 32 bits and only compared as offsets
+ * from the last emission of a key.
+ */
+
+#include <zephyr/kernel.h>
+
+#include <zmk/template/matrix.h>
+#include <zmk/template/shadow_debounce.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static const struct zmk_template_shadow_timing
+    timings[ZMK_TEMPLATE_SHADOW_COUNT] = {
+        [ZMK_TEMPLATE_SHADOW_EAGER] =
+            {
+                .press_ms = CONFIG_ZMK_TEMPLATE_FEATURE_SHADOW_EAGER_MS,
+                .release_ms = CONFIG_ZMK_TEMPLATE_FEATURE_SHADOW_EAGER_MS,
+                .press_eager = true,
+                .release_eager = true,
+            },
+        [ZMK_TEMPLATE_SHADOW_DEFER] =
+            {
+                .press_ms = CONFIG_ZMK_TEMPLATE_FEATURE_SHADOW_DEFER_MS,
+                .release_ms = CONFIG_ZMK_TEMPLATE_FEATURE_SHADOW_DEFER_MS,
+            },
+        [ZMK_TEMPLATE_SHADOW_ASYMMETRIC] =
+            {
+                .press_ms = CONFIG_ZMK_TEMPLATE_FEATURE_SHADOW_ASYM_PRESS_MS,
+                .release_ms =
+                    CONFIG_ZMK_TEMPLATE_FEATURE_SHADOW_ASYM_RELEASE_MS,
+                .press_eager = true,
+            },
+};
+
+// Raw state of a key, shared by all debouncers
+struct raw_key {
+  uint32_t changed_at;
+  bool pressed;
+};
+
+// Output state of one debouncer for a key
+struct shadow_key {
+  uint32_t emitted_at;
+  // First raw edge away from the output since the last emission
+  uint32_t burst_start;
+  bool pressed : 1;
+  bool pending : 1;
+  bool emitted : 1;
+};
+
+static struct k_spinlock lock;
+
+static struct raw_key raw_keys[ZMK_TEMPLATE_KEY_COUNT];
+static struct shadow_key shadow_keys[ZMK_TEMPLATE_SHADOW_COUNT]
+                                    [ZMK_TEMPLATE_KEY_COUNT];
+static struct zmk_template_shadow_stats stats[ZMK_TEMPLATE_SHADOW_COUNT];
+static uint32_t transitions;
+
+static uint32_t window_ticks(const struct zmk_template_shadow_timing *timing,
+                             bool pressed) {
+  return k_ms_to_ticks_ceil32(pressed ? timing->press_ms : timing->release_ms);
+}
+
+static bool is_eager(const struct zmk_template_shadow_timing *timing,
+                     bool pressed) {
+  return pressed ? timing->press_eager : timing->release_eager;
+}
+
+// Time after an emission during which an eager debouncer ignores the key
+static uint32_t lockout_ticks(const struct zmk_template_shadow_timing *timing,
+                              const struct shadow_key *key) {
+  if (!key->emitted || !is_eager(timing, key->pressed)) {
+    return 0;
+  }
+  return window_ticks(timing, key->pressed);
+}
+
+// Must be called with the lock held.
+static void emit(enum zmk_template_shadow_debouncer d, struct shadow_key *key,
+                 uint32_t at) {
+  struct zmk_template_shadow_stats *s = &stats[d];
+  uint32_t latency_us = k_ticks_to_us_floor32(at - key->burst_start);
+
+  key->pressed = !key->pressed;
+  if (key->pressed && key->emitted &&
+      at - key->emitted_at <
+          k_ms_to_ticks_ceil32(CONFIG_ZMK_TEMPLATE_FEATURE_CHATTER_WINDOW_MS)) {
+    s->chatter++;
+  }
+  key->emitted_at = at;
+  key->emitted = true;
+  key->pending = false;
+
+  s->emitted++;
+  if (latency_us > 0) {
+    s->delayed++;
+    s->latency_total_us += latency_us;
+    s->latency_max_us = MAX(s->latency_max_us, latency_us);
+  }
+
+  LOG_DBG("debouncer %d pressed %d latency %d ms emitted %d delayed %d "
+          "suppressed %d",
+          d, key->pressed, latency_us / 1000, s->emitted, s->delayed,
+          transitions - s->emitted);
+}
+
+/**
+ * Resolve an emission that became due by `until` while the raw state held
+ * still. Must be called with the lock held.
+ */
+static void settle(enum zmk_template_shadow_debouncer d, uint32_t position,
+                   uint32_t until) {
+  const struct zmk_template_shadow_timing *timing = &timings[d];
+  const struct raw_key *raw = &raw_keys[position];
+  struct shadow_key *key = &shadow_keys[d][position];
+
+  if (raw->pressed == key->pressed) {
+    return;
+  }
+
+  uint32_t changed = raw->changed_at - key->emitted_at;
+  uint32_t due = MAX(is_eager(timing, raw->pressed)
+                         ? changed
+                         : changed + window_ticks(timing, raw->pressed),
+                     lockout_ticks(timing, key));
+
+  if (due <= until - key->emitted_at) {
+    emit(d, key, key->emitted_at + due);
+  }
+}
+
+/**
+ * Apply a raw edge that came after the previous raw state held still for
+ * `held` ticks. Must be called with the lock held.
+ */
+static void edge(enum zmk_template_shadow_debouncer d, uint32_t position,
+                 uint32_t now, uint32_t held) {
+  const struct zmk_template_shadow_timing *timing = &timings[d];
+  const struct raw_key *raw = &raw_keys[position];
+  struct shadow_key *key = &shadow_keys[d][position];
+
+  if (raw->pressed == key->pressed) {
+    return;
+  }
+
+  // A bounce back to the output that held still long enough ended the
+  // previous burst without an emission.
+  if (!key->pending || held >= window_ticks(timing, key->pressed)) {
+    key->pending = true;
+    key->burst_start = now;
+  }
+
+  if (is_eager(timing, raw->pressed) &&
+      now - key->emitted_at >= lockout_ticks(timing, key)) {
+    emit(d, key, now);
+  }
+}
+
+void zmk_template_shadow_debounce_record(uint32_t position, bool pressed,
+                                        uint32_t now) {
+  if (position >= ZMK_TEMPLATE_KEY_COUNT) {
+    return;
+  }
+
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  struct raw_key *raw = &raw_keys[position];
+
+  if (raw->pressed != pressed) {
+    uint32_t held = now - raw->changed_at;
+
+    for (int d = 0; d < ZMK_TEMPLATE_SHADOW_COUNT; d++) {
+      settle(d, position, now);
+    }
+
+    raw->pressed = pressed;
+    raw->changed_at = now;
+    transitions++;
+
+    for (int d = 0; d < ZMK_TEMPLATE_SHADOW_COUNT; d++) {
+      edge(d, position, now, held);
+    }
+  }
+
+  k_spin_unlock(&lock, key);
+}
+
+uint32_t zmk_template_shadow_debounce_transitions(void) {
+  return transitions;
+}
+
+const struct zmk_template_shadow_timing *
+zmk_template_shadow_debounce_timing(enum zmk_template_shadow_debouncer d) {
+  return &timings[d];
+}
+
+void zmk_template_shadow_debounce_get(enum zmk_template_shadow_debouncer d,
+                                      struct zmk_template_shadow_stats *out) {
+  uint32_t now = (uint32_t)k_uptime_ticks();
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  for (uint32_t pos = 0; pos < ZMK_TEMPLATE_KEY_COUNT; pos++) {
+    settle(d, pos, now);
+  }
+  *out = stats[d];
+  out->suppressed = transitions - out->emitted;
+
+  k_spin_unlock(&lock, key);
+}
@@ -0,0 +1,136 @@
+/**
+ * Template Feature - Stuck Key Watchdog
+ *
+ * Instead of a timer per key, one delayable work item is scheduled for the
+ * earliest deadline among held keys. When it runs it scans the held keys once
+ * (O(keys) per expiry, nothing per keypress besides a timestamp), flags the
+ * ones past the threshold and reschedules for the next deadline. Since every
+ * key has the same threshold, a new press never moves the earliest deadline
+ * forward and only needs to start the timer if it is idle.
+ *
+ * The scan runs on the analysis workqueue, like the analysis that feeds it.
+ * Changes are handed to a second work item on the system workqueue, which
+ * raises the events from the same thread as the rest of ZMK.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include <zmk/template/analysis.h>
+#include <zmk/template/events/stuck_key_changed.h>
+#include <zmk/template/stuck.h>
+#include <zmk/template/trigger.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+// k_uptime_get_32() at the last press of each key. Cycle timestamps wrap too
+// quickly for thresholds of several seconds.
+static uint32_t pressed_at[ZMK_TEMPLATE_KEY_COUNT];
+static ATOMIC_DEFINE(held, ZMK_TEMPLATE_KEY_COUNT);
+static ATOMIC_DEFINE(stuck, ZMK_TEMPLATE_KEY_COUNT);
+// Keys flagged and stuck keys released since the last raise, and for how
+// long they had been held
+static ATOMIC_DEFINE(flagged, ZMK_TEMPLATE_KEY_COUNT);
+static uint32_t flagged_held_ms[ZMK_TEMPLATE_KEY_COUNT];
+static ATOMIC_DEFINE(recovered, ZMK_TEMPLATE_KEY_COUNT);
+static uint32_t recovered_held_ms[ZMK_TEMPLATE_KEY_COUNT];
+static atomic_t stuck_total;
+
+static void stuck_raise(struct k_work *work) {
+  for (int pos = 0; pos < ZMK_TEMPLATE_KEY_COUNT; pos++) {
+    // A key flagged and released since the last run gets both events.
+    if (atomic_test_and_clear_bit(flagged, pos)) {
+      raise_zmk_template_stuck_key_changed(
+          (struct zmk_template_stuck_key_changed){
+              .position = pos,
+              .stuck = true,
+              .held_ms = flagged_held_ms[pos],
+          });
+    }
+    if (atomic_test_and_clear_bit(recovered, pos)) {
+      raise_zmk_template_stuck_key_changed(
+          (struct zmk_template_stuck_key_changed){
+              .position = pos,
+              .stuck = false,
+              .held_ms = recovered_held_ms[pos],
+          });
+    }
+  }
+}
+
+static K_WORK_DEFINE(stuck_raise_work, stuck_raise);
+
+static void stuck_scan(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(stuck_scan_work, stuck_scan);
+
+static void stuck_scan(struct k_work *work) {
+  uint32_t now = k_uptime_get_32();
+  uint32_t next_deadline_ms = UINT32_MAX;
+
+  for (int pos = 0; pos < ZMK_TEMPLATE_KEY_COUNT; pos++) {
+    if (!atomic_test_bit(held, pos) || atomic_test_bit(stuck, pos)) {
+      continue;
+    }
+
+    uint32_t held_ms = now - pressed_at[pos];
+    if (held_ms < ZMK_TEMPLATE_STUCK_THRESHOLD_MS) {
+      next_deadline_ms =
+          MIN(next_deadline_ms, ZMK_TEMPLATE_STUCK_THRESHOLD_MS - held_ms);
+      continue;
+    }
+
+    atomic_set_bit(stuck, pos);
+    atomic_inc(&stuck_total);
+    LOG_WRN("position %d stuck for %d ms", pos, held_ms);
+
+    zmk_template_trigger_fire(ZMK_TEMPLATE_TRIGGER_STUCK);
+    flagged_held_ms[pos] = held_ms;
+    atomic_set_bit(flagged, pos);
+    k_work_submit(&stuck_raise_work);
+  }
+
+  if (next_deadline_ms != UINT32_MAX) {
+    k_work_schedule_for_queue(zmk_template_analysis_queue(), &stuck_scan_work,
+                              K_MSEC(next_deadline_ms));
+  }
+}
+
+void zmk_template_stuck_record(uint32_t position, bool pressed) {
+  if (position >= ZMK_TEMPLATE_KEY_COUNT) {
+    return;
+  }
+
+  if (pressed) {
+    pressed_at[position] = k_uptime_get_32();
+    atomic_clear_bit(stuck, position);
+    atomic_set_bit(held, position);
+    // No-op while a scan is already scheduled for an earlier deadline.
+    k_work_schedule_for_queue(zmk_template_analysis_queue(), &stuck_scan_work,
+                              K_MSEC(ZMK_TEMPLATE_STUCK_THRESHOLD_MS));
+    return;
+  }
+
+  atomic_clear_bit(held, position);
+  if (atomic_test_and_clear_bit(stuck, position)) {
+    recovered_held_ms[position] = k_uptime_get_32() - pressed_at[position];
+    LOG_INF("position %d released after %d ms stuck", position,
+            recovered_held_ms[position]);
+    atomic_set_bit(recovered, position);
+    k_work_submit(&stuck_raise_work);
+  }
+}
+
+bool zmk_template_stuck_get(uint32_t position, uint32_t *held_ms) {
+  if (position >= ZMK_TEMPLATE_KEY_COUNT ||
+      !atomic_test_bit(stuck, position)) {
+    return false;
+  }
+
+  *held_ms = k_uptime_get_32() - pressed_at[position];
+  return true;
+}
+
+uint32_t zmk_template_stuck_total(void) {
+  return (uint32_t)atomic_get(&stuck_total);
+}
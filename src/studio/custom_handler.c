@@ -7,8 +7,30 @@
 
 #include <pb_decode.h>
 #include <pb_encode.h>
+#include <zephyr/kernel.h>
 #include <zmk/studio/custom.h>
+#include <zmk/template/analysis.h>
+#include <zmk/template/behavior_latency.h>
+#include <zmk/template/bounce.h>
+#include <zmk/template/budget.h>
+#include <zmk/template/capture.h>
+#include <zmk/template/chatter.h>
+#include <zmk/template/counter.h>
 #include <zmk/template/custom.pb.h>
+#include <zmk/template/event_profile.h>
+#include <zmk/template/ghost.h>
+#include <zmk/template/hid_stats.h>
+#include <zmk/template/histogram.h>
+#include <zmk/template/hold_quantiles.h>
+#include <zmk/template/key_counters.h>
+#include <zmk/template/kscan_tap.h>
+#include <zmk/template/latency.h>
+#include <zmk/template/matrix_state.h>
+#include <zmk/template/scan_timing.h>
+#include <zmk/template/shadow_debounce.h>
+#include <zmk/template/stream.h>
+#include <zmk/template/stuck.h>
+#include <zmk/template/trigger.h>
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
@@ -35,8 +57,128 @@ ZMK_RPC_CUSTOM_SUBSYSTEM(zmk__template, &template_feature_meta,
 
 ZMK_RPC_CUSTOM_SUBSYSTEM_RESPONSE_BUFFER(zmk__template, zmk_template_Response);
 
+struct key_counter_page {
+  const zmk_template_counter_t *column;
+  size_t offset;
+  size_t count;
+};
+
+struct ghost_suspect_range {
+  uint32_t first;
+  uint32_t end;
+};
+
+struct trigger_slice_range {
+  size_t offset;
+  size_t count;
+};
+
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_EVENT_PROFILE)
+struct event_profile_selection {
+  // Event types listed by the response, one bit per type
+  uint8_t types[DIV_ROUND_UP(
+      CONFIG_ZMK_TEMPLATE_FEATURE_EVENT_PROFILE_MAX_TYPES, 8)];
+  // Restart the profiles once the response is written
+  bool reset;
+};
+#endif
+
+/**
+ * Arguments of the nanopb encode callbacks of the response being built. They
+ * must live until the response is encoded; batched responses are encoded as
+ * soon as their request has run, so one set serves every item.
+ */
+union response_args {
+  struct {
+    struct key_counter_page presses;
+    struct key_counter_page releases;
+  } key_counters;
+  struct ghost_suspect_range ghost;
+  struct trigger_slice_range trigger;
+  // Keys listed by a response, one bit per position
+  uint8_t keys[DIV_ROUND_UP(ZMK_TEMPLATE_KEY_COUNT, 8)];
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_EVENT_PROFILE)
+  struct event_profile_selection event_profile;
+#endif
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_BEHAVIOR_LATENCY)
+  // Behaviors listed by a response, one bit per entry
+  uint8_t behaviors[DIV_ROUND_UP(
+      CONFIG_ZMK_TEMPLATE_FEATURE_BEHAVIOR_LATENCY_MAX, 8)];
+#endif
+  // Events written by a ReadEvents response
+  size_t events;
+};
+
+static union response_args response_args;
+
+// Arguments of the response being built
+static union response_args *const args = &response_args;
+
 static int handle_sample_request(const zmk_template_SampleRequest *req,
                                  zmk_template_Response *resp);
+static int
+handle_read_events_request(const zmk_template_ReadEventsRequest *req,
+                           zmk_template_Response *resp);
+static int
+handle_get_tap_stats_request(const zmk_template_GetTapStatsRequest *req,
+                             zmk_template_Response *resp);
+static int
+handle_get_key_counters_request(const zmk_template_GetKeyCountersRequest *req,
+                                zmk_template_Response *resp);
+static int
+handle_get_chatter_stats_request(const zmk_template_GetChatterStatsRequest *req,
+                                 zmk_template_Response *resp);
+static int handle_get_latency_breakdown_request(
+    const zmk_template_GetLatencyBreakdownRequest *req,
+    zmk_template_Response *resp);
+static int
+handle_subscribe_events_request(const zmk_template_SubscribeEventsRequest *req,
+                                zmk_template_Response *resp);
+static int
+handle_get_matrix_state_request(const zmk_template_GetMatrixStateRequest *req,
+                                zmk_template_Response *resp);
+static int
+handle_get_ghost_report_request(const zmk_template_GetGhostReportRequest *req,
+                                zmk_template_Response *resp);
+static void dispatch_request(const zmk_template_Request *req,
+                             zmk_template_Response *resp);
+static void handle_batch_request(const zmk_custom_CallRequest *raw_request,
+                                 zmk_template_Response *resp);
+static int handle_get_key_counter_changes_request(
+    const zmk_template_GetKeyCounterChangesRequest *req,
+    zmk_template_Response *resp);
+static int handle_arm_trigger_request(const zmk_template_ArmTriggerRequest *req,
+                                      zmk_template_Response *resp);
+static int handle_get_trigger_capture_request(
+    const zmk_template_GetTriggerCaptureRequest *req,
+    zmk_template_Response *resp);
+static int
+handle_get_stuck_keys_request(const zmk_template_GetStuckKeysRequest *req,
+                              zmk_template_Response *resp);
+static int handle_get_hold_quantiles_request(
+    const zmk_template_GetHoldQuantilesRequest *req,
+    zmk_template_Response *resp);
+static int
+handle_get_bounce_stats_request(const zmk_template_GetBounceStatsRequest *req,
+                                zmk_template_Response *resp);
+static int handle_get_shadow_debounce_request(
+    const zmk_template_GetShadowDebounceRequest *req,
+    zmk_template_Response *resp);
+static int
+handle_get_scan_timing_request(const zmk_template_GetScanTimingRequest *req,
+                               zmk_template_Response *resp);
+static int
+handle_get_overhead_request(const zmk_template_GetOverheadRequest *req,
+                            zmk_template_Response *resp);
+static int
+handle_get_event_profile_request(const zmk_template_GetEventProfileRequest *req,
+                                 zmk_template_Response *resp);
+static int handle_get_behavior_latency_request(
+    const zmk_template_GetBehaviorLatencyRequest *req,
+    zmk_template_Response *resp);
+static int
+handle_get_hid_stats_request(const zmk_template_GetHidStatsRequest *req,
+                             zmk_template_Response *resp);
 
 /**
  * Main request handler for the custom RPC subsystem.
@@ -63,13 +205,101 @@ template_rpc_handle_request(const zmk_custom_CallRequest *raw_request,
     return true;
   }
 
+  if (req.which_request_type == zmk_template_Request_batch_tag) {
+    handle_batch_request(raw_request, resp);
+  } else {
+    dispatch_request(&req, resp);
+  }
+  return true;
+}
+
+/**
+ * Run a single decoded request. A failed handler is reported to the host as
+ * an ErrorResponse.
+ */
+static void dispatch_request(const zmk_template_Request *req,
+                             zmk_template_Response *resp) {
   int rc = 0;
-  switch (req.which_request_type) {
+  switch (req->which_request_type) {
   case zmk_template_Request_sample_tag:
-    rc = handle_sample_request(&req.request_type.sample, resp);
+    rc = handle_sample_request(&req->request_type.sample, resp);
+    break;
+  case zmk_template_Request_read_events_tag:
+    rc = handle_read_events_request(&req->request_type.read_events, resp);
+    break;
+  case zmk_template_Request_get_tap_stats_tag:
+    rc = handle_get_tap_stats_request(&req->request_type.get_tap_stats, resp);
+    break;
+  case zmk_template_Request_get_key_counters_tag:
+    rc = handle_get_key_counters_request(&req->request_type.get_key_counters,
+                                         resp);
+    break;
+  case zmk_template_Request_get_chatter_stats_tag:
+    rc = handle_get_chatter_stats_request(&req->request_type.get_chatter_stats,
+                                          resp);
+    break;
+  case zmk_template_Request_get_latency_breakdown_tag:
+    rc = handle_get_latency_breakdown_request(
+        &req->request_type.get_latency_breakdown, resp);
+    break;
+  case zmk_template_Request_subscribe_events_tag:
+    rc = handle_subscribe_events_request(&req->request_type.subscribe_events,
+                                         resp);
+    break;
+  case zmk_template_Request_get_matrix_state_tag:
+    rc = handle_get_matrix_state_request(&req->request_type.get_matrix_state,
+                                         resp);
+    break;
+  case zmk_template_Request_get_ghost_report_tag:
+    rc = handle_get_ghost_report_request(&req->request_type.get_ghost_report,
+                                         resp);
+    break;
+  case zmk_template_Request_get_key_counter_changes_tag:
+    rc = handle_get_key_counter_changes_request(
+        &req->request_type.get_key_counter_changes, resp);
+    break;
+  case zmk_template_Request_arm_trigger_tag:
+    rc = handle_arm_trigger_request(&req->request_type.arm_trigger, resp);
+    break;
+  case zmk_template_Request_get_trigger_capture_tag:
+    rc = handle_get_trigger_capture_request(
+        &req->request_type.get_trigger_capture, resp);
+    break;
+  case zmk_template_Request_get_stuck_keys_tag:
+    rc = handle_get_stuck_keys_request(&req->request_type.get_stuck_keys, resp);
+    break;
+  case zmk_template_Request_get_hold_quantiles_tag:
+    rc = handle_get_hold_quantiles_request(
+        &req->request_type.get_hold_quantiles, resp);
+    break;
+  case zmk_template_Request_get_bounce_stats_tag:
+    rc = handle_get_bounce_stats_request(&req->request_type.get_bounce_stats,
+                                         resp);
+    break;
+  case zmk_template_Request_get_shadow_debounce_tag:
+    rc = handle_get_shadow_debounce_request(
+        &req->request_type.get_shadow_debounce, resp);
+    break;
+  case zmk_template_Request_get_scan_timing_tag:
+    rc = handle_get_scan_timing_request(&req->request_type.get_scan_timing,
+                                        resp);
+    break;
+  case zmk_template_Request_get_overhead_tag:
+    rc = handle_get_overhead_request(&req->request_type.get_overhead, resp);
+    break;
+  case zmk_template_Request_get_event_profile_tag:
+    rc = handle_get_event_profile_request(&req->request_type.get_event_profile,
+                                          resp);
+    break;
+  case zmk_template_Request_get_behavior_latency_tag:
+    rc = handle_get_behavior_latency_request(
+        &req->request_type.get_behavior_latency, resp);
+    break;
+  case zmk_template_Request_get_hid_stats_tag:
+    rc = handle_get_hid_stats_request(&req->request_type.get_hid_stats, resp);
     break;
   default:
-    LOG_WRN("Unsupported template request type: %d", req.which_request_type);
+    LOG_WRN("Unsupported template request type: %d", req->which_request_type);
     rc = -1;
   }
 
@@ -79,7 +309,6 @@ template_rpc_handle_request(const zmk_custom_CallRequest *raw_request,
     resp->which_response_type = zmk_template_Response_error_tag;
     resp->response_type.error = err;
   }
-  return true;
 }
 
 /**
@@ -98,4 +327,1289 @@ static int handle_sample_request(const zmk_template_SampleRequest *req,
   resp->which_response_type = zmk_template_Response_sample_tag;
   resp->response_type.sample = result;
   return 0;
-}
\ No newline at end of file
+}
+
+// Upper bound of events per ReadEvents response
+#define READ_EVENTS_MAX 32
+
+/**
+ * Encode the first `*arg` captured events in place. Events are only consumed
+ * once the writing pass is done, so the sizing pass sees the same ones.
+ */
+static bool encode_read_events(pb_ostream_t *stream, const pb_field_t *field,
+                               void *const *arg) {
+  const size_t *count = *arg;
+
+  for (size_t i = 0; i < *count; i++) {
+    struct zmk_template_key_event ev;
+    if (!zmk_template_capture_peek(i, &ev)) {
+      return false;
+    }
+
+    zmk_template_KeyEvent event = {
+        .position = ev.position,
+        .pressed = ev.pressed,
+        .timestamp = ev.timestamp,
+    };
+    if (!pb_encode_tag_for_field(stream, field) ||
+        !pb_encode_submessage(stream, zmk_template_KeyEvent_fields, &event)) {
+      return false;
+    }
+  }
+
+  // Sizing streams have no callback.
+  if (stream->callback != NULL) {
+    zmk_template_capture_consume(*count);
+  }
+  return true;
+}
+
+/**
+ * Handle the ReadEventsRequest by draining a batch from the capture ring.
+ * Fails while the event stream is enabled, as the ring has a single consumer.
+ */
+static int
+handle_read_events_request(const zmk_template_ReadEventsRequest *req,
+                           zmk_template_Response *resp) {
+  size_t *count = &args->events;
+
+  if (zmk_template_stream_enabled()) {
+    LOG_WRN("ReadEvents is unavailable while streaming");
+    return -EBUSY;
+  }
+
+  size_t max = READ_EVENTS_MAX;
+  if (req->max_events > 0 && req->max_events < max) {
+    max = req->max_events;
+  }
+
+  // Events captured after this point are left for the next request.
+  size_t pending = zmk_template_capture_pending();
+  *count = MIN(pending, max);
+
+  zmk_template_ReadEventsResponse result =
+      zmk_template_ReadEventsResponse_init_zero;
+  result.events.funcs.encode = encode_read_events;
+  result.events.arg = count;
+  result.dropped = zmk_template_capture_take_dropped();
+  result.sampled_out = zmk_template_capture_take_sampled_out();
+  result.cycles_per_second = sys_clock_hw_cycles_per_sec();
+  result.remaining = pending - *count;
+
+  resp->which_response_type = zmk_template_Response_read_events_tag;
+  resp->response_type.read_events = result;
+  return 0;
+}
+
+/**
+ * Handle the GetTapStatsRequest. Fails when no kscan tap is configured.
+ */
+static int
+handle_get_tap_stats_request(const zmk_template_GetTapStatsRequest *req,
+                             zmk_template_Response *resp) {
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_KSCAN_TAP)
+  struct zmk_template_kscan_tap_stats stats;
+  zmk_template_kscan_tap_get_stats(&stats);
+
+  zmk_template_TapStatsResponse result =
+      zmk_template_TapStatsResponse_init_zero;
+  result.events = stats.events;
+  result.unmapped = stats.unmapped;
+  result.overhead_total_ns = stats.overhead_total_ns;
+  result.overhead_max_ns = stats.overhead_max_ns;
+
+  resp->which_response_type = zmk_template_Response_tap_stats_tag;
+  resp->response_type.tap_stats = result;
+  return 0;
+#else
+  LOG_WRN("No zmk,kscan-diagnostics-tap configured");
+  return -ENOTSUP;
+#endif
+}
+
+// Response tag and length, plus the tag and length of the PageInfo field
+#define PAGE_FRAMING_BYTES (4 + 2)
+
+/**
+ * Encoded size of a paged response besides its table entries: the fields
+ * already set in `result`, which must not have its table callbacks set yet,
+ * and the page info.
+ */
+static size_t page_overhead(const pb_msgdesc_t *fields, const void *result) {
+  size_t size = 0;
+
+  if (!pb_get_encoded_size(&size, fields, result)) {
+    return SIZE_MAX;
+  }
+  return size + PAGE_FRAMING_BYTES + zmk_template_PageInfo_size;
+}
+
+/**
+ * Number of table entries of `entry_bytes` each that fit in the page size
+ * hint besides `overhead`. At least one entry is always returned so a dump
+ * makes progress.
+ */
+static size_t page_capacity(const zmk_template_PageRequest *page,
+                            size_t overhead, size_t entry_bytes) {
+  if (page->max_bytes == 0) {
+    return SIZE_MAX;
+  }
+  if (overhead > page->max_bytes ||
+      page->max_bytes - overhead < entry_bytes) {
+    return 1;
+  }
+  return (page->max_bytes - overhead) / entry_bytes;
+}
+
+/**
+ * Describe a page covering [offset, next_offset). Paging keeps no state
+ * besides the capture generation: a client detects changes between pages by
+ * sending back the generation of its first page.
+ */
+static zmk_template_PageInfo page_info(const zmk_template_PageRequest *page,
+                                       uint32_t offset, uint32_t next_offset) {
+  zmk_template_PageInfo info = zmk_template_PageInfo_init_zero;
+  uint32_t generation = zmk_template_analysis_generation();
+
+  info.offset = offset;
+  info.next_offset = next_offset;
+  info.more = next_offset < ZMK_TEMPLATE_KEY_COUNT;
+  info.generation = page->generation == 0 ? generation : page->generation;
+  info.consistent = page->generation == 0 || page->generation == generation;
+  return info;
+}
+
+/**
+ * Encode a range of a counter column as a packed fixed32 field. The size only
+ * depends on the range, so both nanopb passes agree even while the counters
+ * advance.
+ */
+static bool encode_key_counter_column(pb_ostream_t *stream,
+                                      const pb_field_t *field,
+                                      void *const *arg) {
+  const struct key_counter_page *page = *arg;
+
+  // Sizing streams have no callback.
+  if (stream->callback != NULL) {
+    LOG_DBG("offset %zu count %zu", page->offset, page->count);
+  }
+
+  if (!pb_encode_tag(stream, PB_WT_STRING, field->tag) ||
+      !pb_encode_varint(stream, page->count * sizeof(uint32_t))) {
+    return false;
+  }
+  for (size_t i = 0; i < page->count; i++) {
+    uint32_t value =
+        zmk_template_counter_read(&page->column[page->offset + i]);
+    if (!pb_encode_fixed32(stream, &value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Handle the GetKeyCountersRequest. The requested page of the counter columns
+ * is encoded straight from the live tables.
+ */
+static int
+handle_get_key_counters_request(const zmk_template_GetKeyCountersRequest *req,
+                                zmk_template_Response *resp) {
+  const struct zmk_template_key_counters *counters =
+      zmk_template_key_counters_get();
+
+  if (req->page.offset > ZMK_TEMPLATE_KEY_COUNT) {
+    return -EINVAL;
+  }
+
+  zmk_template_KeyCountersResponse result =
+      zmk_template_KeyCountersResponse_init_zero;
+  result.key_count = ZMK_TEMPLATE_KEY_COUNT;
+  result.counters_lost = zmk_template_counter_lost();
+  result.analysis_dropped = zmk_template_analysis_dropped();
+
+  // A press and a release counter per key, in two packed columns with a tag
+  // and length each
+  size_t offset = req->page.offset;
+  size_t overhead =
+      page_overhead(zmk_template_KeyCountersResponse_fields, &result) + 2 * 4;
+  size_t count =
+      MIN(ZMK_TEMPLATE_KEY_COUNT - offset,
+          page_capacity(&req->page, overhead, 2 * sizeof(uint32_t)));
+
+  args->key_counters.presses =
+      (struct key_counter_page){counters->presses, offset, count};
+  args->key_counters.releases =
+      (struct key_counter_page){counters->releases, offset, count};
+
+  result.presses.funcs.encode = encode_key_counter_column;
+  result.presses.arg = &args->key_counters.presses;
+  result.releases.funcs.encode = encode_key_counter_column;
+  result.releases.arg = &args->key_counters.releases;
+  result.has_page = true;
+  result.page = page_info(&req->page, offset, offset + count);
+
+  resp->which_response_type = zmk_template_Response_key_counters_tag;
+  resp->response_type.key_counters = result;
+  return 0;
+}
+
+/**
+ * Encode a histogram for each key set in the `*arg` bitmap. Bucket counts are
+ * fixed width and the set of keys is fixed by the handler, so both nanopb
+ * passes agree even while keys keep chattering.
+ */
+static bool encode_chatter_histograms(pb_ostream_t *stream,
+                                      const pb_field_t *field,
+                                      void *const *arg) {
+  const uint8_t *chattered = *arg;
+  const struct zmk_template_chatter_stats *stats = zmk_template_chatter_get();
+
+  for (int pos = 0; pos < ZMK_TEMPLATE_KEY_COUNT; pos++) {
+    if (!(chattered[pos / 8] & BIT(pos % 8))) {
+      continue;
+    }
+
+    zmk_template_ChatterHistogram histogram =
+        zmk_template_ChatterHistogram_init_zero;
+    histogram.position = pos;
+    for (int b = 0; b < ZMK_TEMPLATE_CHATTER_BUCKETS; b++) {
+      histogram.buckets[b] =
+          zmk_template_counter_read(&stats->histogram[pos][b]);
+    }
+    histogram.buckets_count = ZMK_TEMPLATE_CHATTER_BUCKETS;
+
+    if (!pb_encode_tag_for_field(stream, field) ||
+        !pb_encode_submessage(stream, zmk_template_ChatterHistogram_fields,
+                              &histogram)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Handle the GetChatterStatsRequest. Only keys of the requested page that
+ * chattered are listed.
+ */
+static int
+handle_get_chatter_stats_request(const zmk_template_GetChatterStatsRequest *req,
+                                 zmk_template_Response *resp) {
+  uint8_t *chattered = args->keys;
+  const struct zmk_template_chatter_stats *stats = zmk_template_chatter_get();
+
+  zmk_template_ChatterStatsResponse result =
+      zmk_template_ChatterStatsResponse_init_zero;
+  BUILD_ASSERT(ZMK_TEMPLATE_CHATTER_BUCKETS <=
+               ARRAY_SIZE(((zmk_template_ChatterHistogram *)0)->buckets));
+
+  result.window_ms = CONFIG_ZMK_TEMPLATE_FEATURE_CHATTER_WINDOW_MS;
+  result.total = stats->total;
+  for (int b = 0; b < ZMK_TEMPLATE_CHATTER_BUCKETS; b++) {
+    result.bucket_floor_us[b] =
+        zmk_template_log2_bucket_floor(b, ZMK_TEMPLATE_CHATTER_MIN_SHIFT);
+  }
+  result.bucket_floor_us_count = ZMK_TEMPLATE_CHATTER_BUCKETS;
+
+  if (req->page.offset > ZMK_TEMPLATE_KEY_COUNT) {
+    return -EINVAL;
+  }
+
+  // Position, bucket counts and the tags and lengths around them
+  size_t capacity = page_capacity(
+      &req->page,
+      page_overhead(zmk_template_ChatterStatsResponse_fields, &result),
+      12 + ZMK_TEMPLATE_CHATTER_BUCKETS * sizeof(uint32_t));
+  int pos = req->page.offset;
+
+  memset(chattered, 0, sizeof(args->keys));
+  for (size_t listed = 0; pos < ZMK_TEMPLATE_KEY_COUNT && listed < capacity;
+       pos++) {
+    for (int b = 0; b < ZMK_TEMPLATE_CHATTER_BUCKETS; b++) {
+      if (zmk_template_counter_read(&stats->histogram[pos][b]) > 0) {
+        chattered[pos / 8] |= BIT(pos % 8);
+        listed++;
+        break;
+      }
+    }
+  }
+  result.histograms.funcs.encode = encode_chatter_histograms;
+  result.histograms.arg = chattered;
+  result.has_page = true;
+  result.page = page_info(&req->page, req->page.offset, pos);
+
+  resp->which_response_type = zmk_template_Response_chatter_stats_tag;
+  resp->response_type.chatter_stats = result;
+  return 0;
+}
+
+/**
+ * Handle the GetLatencyBreakdownRequest with percentiles of every stage.
+ */
+static int handle_get_latency_breakdown_request(
+    const zmk_template_GetLatencyBreakdownRequest *req,
+    zmk_template_Response *resp) {
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_LATENCY)
+  zmk_template_LatencyBreakdownResponse result =
+      zmk_template_LatencyBreakdownResponse_init_zero;
+  BUILD_ASSERT(ZMK_TEMPLATE_LATENCY_STAGE_COUNT <= ARRAY_SIZE(result.stages));
+
+  for (int stage = 0; stage < ZMK_TEMPLATE_LATENCY_STAGE_COUNT; stage++) {
+    const struct zmk_template_latency_histogram *histogram =
+        zmk_template_latency_get(stage);
+    zmk_template_StageLatency *out = &result.stages[stage];
+
+    out->stage = (zmk_template_LatencyStage)stage;
+    out->count = histogram->count;
+    out->p50_us = zmk_template_latency_percentile_us(histogram, 50);
+    out->p90_us = zmk_template_latency_percentile_us(histogram, 90);
+    out->p99_us = zmk_template_latency_percentile_us(histogram, 99);
+    out->max_us = histogram->max_us;
+  }
+  result.stages_count = ZMK_TEMPLATE_LATENCY_STAGE_COUNT;
+
+  resp->which_response_type = zmk_template_Response_latency_breakdown_tag;
+  resp->response_type.latency_breakdown = result;
+  return 0;
+#else
+  LOG_WRN("Latency measurement is not enabled");
+  return -ENOTSUP;
+#endif
+}
+
+/**
+ * Handle the SubscribeEventsRequest by starting or stopping the event stream.
+ * The response echoes the settings actually in effect.
+ */
+static int
+handle_subscribe_events_request(const zmk_template_SubscribeEventsRequest *req,
+                                zmk_template_Response *resp) {
+  struct zmk_template_stream_config config = {
+      .enabled = req->enable,
+      .interval_ms = req->interval_ms,
+      .max_events = req->max_events,
+  };
+
+  zmk_template_stream_configure(&config);
+
+  zmk_template_SubscribeEventsResponse result =
+      zmk_template_SubscribeEventsResponse_init_zero;
+  result.enabled = config.enabled;
+  result.interval_ms = config.interval_ms;
+  result.max_events = config.max_events;
+
+  resp->which_response_type = zmk_template_Response_subscribe_events_tag;
+  resp->response_type.subscribe_events = result;
+  return 0;
+}
+
+/**
+ * Encode the pressed-state bitmap. Its length only depends on the key count,
+ * so both nanopb passes agree while keys change.
+ */
+static bool encode_matrix_state(pb_ostream_t *stream, const pb_field_t *field,
+                                void *const *arg) {
+  uint8_t pressed[ZMK_TEMPLATE_MATRIX_STATE_BYTES];
+  size_t len = zmk_template_matrix_state_snapshot(pressed, sizeof(pressed));
+
+  return pb_encode_tag_for_field(stream, field) &&
+         pb_encode_string(stream, pressed, len);
+}
+
+/**
+ * Handle the GetMatrixStateRequest with a packed bitmap of pressed keys.
+ */
+static int
+handle_get_matrix_state_request(const zmk_template_GetMatrixStateRequest *req,
+                                zmk_template_Response *resp) {
+  zmk_template_MatrixStateResponse result =
+      zmk_template_MatrixStateResponse_init_zero;
+
+  result.key_count = ZMK_TEMPLATE_KEY_COUNT;
+  result.pressed.funcs.encode = encode_matrix_state;
+
+  resp->which_response_type = zmk_template_Response_matrix_state_tag;
+  resp->response_type.matrix_state = result;
+  return 0;
+}
+
+/**
+ * Encode the suspects numbered in `*arg`, oldest first. Fails if one of them
+ * was overwritten by a newer suspect meanwhile; the host retries.
+ */
+static bool encode_ghost_suspects(pb_ostream_t *stream, const pb_field_t *field,
+                                  void *const *arg) {
+  const struct ghost_suspect_range *range = *arg;
+  const struct zmk_template_ghost_report *report = zmk_template_ghost_get();
+
+  if (report->total - range->first > ZMK_TEMPLATE_GHOST_HISTORY) {
+    return false;
+  }
+
+  for (uint32_t n = range->first; n != range->end; n++) {
+    const struct zmk_template_ghost_suspect *s =
+        &report->suspects[n % ZMK_TEMPLATE_GHOST_HISTORY];
+    zmk_template_GhostSuspect suspect = {
+        .position = s->position,
+        .timestamp = s->timestamp,
+        .row = s->row,
+        .column = s->column,
+        .other_row = s->other_row,
+        .other_column = s->other_column,
+        .rectangles = s->rectangles,
+    };
+
+    if (!pb_encode_tag_for_field(stream, field) ||
+        !pb_encode_submessage(stream, zmk_template_GhostSuspect_fields,
+                              &suspect)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Handle the GetGhostReportRequest. Fails without a matrix transform of at
+ * most 64 columns.
+ */
+static int
+handle_get_ghost_report_request(const zmk_template_GetGhostReportRequest *req,
+                                zmk_template_Response *resp) {
+  struct ghost_suspect_range *range = &args->ghost;
+  const struct zmk_template_ghost_report *report = zmk_template_ghost_get();
+
+  if (report == NULL) {
+    LOG_WRN("Ghost detection needs a matrix transform of at most 64 "
+            "columns");
+    return -ENOTSUP;
+  }
+
+  zmk_template_GhostReportResponse result =
+      zmk_template_GhostReportResponse_init_zero;
+  result.total = report->total;
+  range->end = result.total;
+  range->first = range->end - MIN(range->end, ZMK_TEMPLATE_GHOST_HISTORY);
+  result.suspects.funcs.encode = encode_ghost_suspects;
+  result.suspects.arg = range;
+
+  resp->which_response_type = zmk_template_Response_ghost_report_tag;
+  resp->response_type.ghost_report = result;
+  return 0;
+}
+
+#define BATCH_BUFFER_SIZE CONFIG_ZMK_TEMPLATE_FEATURE_BATCH_BUFFER_SIZE
+
+// Responses of the current batch, encoded as `responses` fields of the
+// BatchResponse as each request runs
+static struct {
+  uint8_t buffer[BATCH_BUFFER_SIZE];
+  size_t used;
+} batch;
+
+static void set_error_response(zmk_template_Response *resp,
+                               const char *message) {
+  zmk_template_ErrorResponse err = zmk_template_ErrorResponse_init_zero;
+  snprintf(err.message, sizeof(err.message), "%s", message);
+  resp->which_response_type = zmk_template_Response_error_tag;
+  resp->response_type.error = err;
+}
+
+static bool encode_batch_responses(pb_ostream_t *stream,
+                                   const pb_field_t *field, void *const *arg) {
+  return pb_write(stream, batch.buffer, batch.used);
+}
+
+/**
+ * Append `resp` to the batch buffer. A partial write is rolled back.
+ */
+static bool append_batch_response(const zmk_template_Response *resp) {
+  pb_ostream_t stream = pb_ostream_from_buffer(batch.buffer + batch.used,
+                                               BATCH_BUFFER_SIZE - batch.used);
+
+  if (!pb_encode_tag(&stream, PB_WT_STRING,
+                     zmk_template_BatchResponse_responses_tag) ||
+      !pb_encode_submessage(&stream, zmk_template_Response_fields, resp)) {
+    return false;
+  }
+  batch.used += stream.bytes_written;
+  return true;
+}
+
+/**
+ * Decode and run one sub-request of a batch and encode its response. Nested
+ * batches are refused, as is ReadEvents, whose events would be lost if its
+ * response did not fit. A response that does not fit is replaced by an
+ * ErrorResponse so the host still gets one response per request.
+ */
+static bool run_batch_item(pb_istream_t *stream) {
+  zmk_template_Request req = zmk_template_Request_init_zero;
+  zmk_template_Response resp = zmk_template_Response_init_zero;
+
+  if (!pb_decode(stream, zmk_template_Request_fields, &req)) {
+    LOG_WRN("Failed to decode batched request: %s", PB_GET_ERROR(stream));
+    set_error_response(&resp, "Failed to decode request");
+  } else if (req.which_request_type == zmk_template_Request_batch_tag ||
+             req.which_request_type == zmk_template_Request_read_events_tag) {
+    LOG_WRN("Request type %d is not allowed in a batch",
+            req.which_request_type);
+    set_error_response(&resp, "Not allowed in a batch");
+  } else {
+    dispatch_request(&req, &resp);
+  }
+
+  if (append_batch_response(&resp)) {
+    return true;
+  }
+  LOG_WRN("Response to request type %d does not fit the batch",
+          req.which_request_type);
+  set_error_response(&resp, "Batch response too large");
+  return append_batch_response(&resp);
+}
+
+/**
+ * Run every `requests` entry of an encoded BatchRequest.
+ */
+static bool run_batch(pb_istream_t *stream) {
+  pb_wire_type_t wire_type;
+  uint32_t tag;
+  bool eof;
+
+  while (pb_decode_tag(stream, &wire_type, &tag, &eof)) {
+    if (tag != zmk_template_BatchRequest_requests_tag ||
+        wire_type != PB_WT_STRING) {
+      if (!pb_skip_field(stream, wire_type)) {
+        return false;
+      }
+      continue;
+    }
+
+    pb_istream_t item;
+    if (!pb_make_string_substream(stream, &item)) {
+      return false;
+    }
+    bool ok = run_batch_item(&item);
+    if (!pb_close_string_substream(stream, &item) || !ok) {
+      return false;
+    }
+  }
+  return eof;
+}
+
+/**
+ * Handle a BatchRequest. Its sub-requests are recursive callback fields that
+ * nanopb skips while decoding the envelope, so they are decoded and run here
+ * one at a time straight from the raw payload.
+ */
+static void handle_batch_request(const zmk_custom_CallRequest *raw_request,
+                                 zmk_template_Response *resp) {
+  pb_istream_t stream = pb_istream_from_buffer(raw_request->payload.bytes,
+                                               raw_request->payload.size);
+  pb_wire_type_t wire_type;
+  uint32_t tag;
+  bool eof;
+
+  batch.used = 0;
+  while (pb_decode_tag(&stream, &wire_type, &tag, &eof)) {
+    bool ok;
+
+    if (tag != zmk_template_Request_batch_tag || wire_type != PB_WT_STRING) {
+      ok = pb_skip_field(&stream, wire_type);
+    } else {
+      pb_istream_t envelope;
+      ok = pb_make_string_substream(&stream, &envelope) &&
+           run_batch(&envelope) &&
+           pb_close_string_substream(&stream, &envelope);
+    }
+
+    if (!ok) {
+      set_error_response(resp, "Failed to process batch");
+      return;
+    }
+  }
+
+  zmk_template_BatchResponse result = zmk_template_BatchResponse_init_zero;
+  result.responses.funcs.encode = encode_batch_responses;
+
+  resp->which_response_type = zmk_template_Response_batch_tag;
+  resp->response_type.batch = result;
+}
+
+/**
+ * Encode the counters of each key set in the `*arg` bitmap. The set of keys
+ * is fixed by the handler and the values are fixed width, so both nanopb
+ * passes agree.
+ */
+static bool encode_key_counter_changes(pb_ostream_t *stream,
+                                       const pb_field_t *field,
+                                       void *const *arg) {
+  const uint8_t *changed = *arg;
+  const struct zmk_template_key_counters *counters =
+      zmk_template_key_counters_get();
+
+  for (int pos = 0; pos < ZMK_TEMPLATE_KEY_COUNT; pos++) {
+    if (!(changed[pos / 8] & BIT(pos % 8))) {
+      continue;
+    }
+
+    zmk_template_KeyCounterChange change = {
+        .position = pos,
+        .presses = zmk_template_counter_read(&counters->presses[pos]),
+        .releases = zmk_template_counter_read(&counters->releases[pos]),
+    };
+    if (!pb_encode_tag_for_field(stream, field) ||
+        !pb_encode_submessage(stream, zmk_template_KeyCounterChange_fields,
+                              &change)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Handle the GetKeyCounterChangesRequest with the counters of the keys
+ * stamped after the requested generation.
+ */
+static int handle_get_key_counter_changes_request(
+    const zmk_template_GetKeyCounterChangesRequest *req,
+    zmk_template_Response *resp) {
+  uint8_t *changed = args->keys;
+  const struct zmk_template_key_counters *counters =
+      zmk_template_key_counters_get();
+
+  // Read the generation first: keys changing while scanning are reported
+  // now and again in the next sync, but never missed.
+  uint32_t generation = zmk_template_analysis_generation();
+
+  memset(changed, 0, sizeof(args->keys));
+  for (int pos = 0; pos < ZMK_TEMPLATE_KEY_COUNT; pos++) {
+    // Wrap-safe "modified after since_generation"
+    if ((int32_t)(counters->modified[pos] - req->since_generation) > 0) {
+      changed[pos / 8] |= BIT(pos % 8);
+    }
+  }
+
+  zmk_template_KeyCounterChangesResponse result =
+      zmk_template_KeyCounterChangesResponse_init_zero;
+  result.generation = generation;
+  result.changes.funcs.encode = encode_key_counter_changes;
+  result.changes.arg = changed;
+
+  resp->which_response_type = zmk_template_Response_key_counter_changes_tag;
+  resp->response_type.key_counter_changes = result;
+  return 0;
+}
+
+/**
+ * Fill a TriggerCaptureResponse with the trigger state and configuration.
+ */
+static zmk_template_TriggerCaptureResponse trigger_status(void) {
+  struct zmk_template_trigger_config config;
+  zmk_template_trigger_get_config(&config);
+
+  zmk_template_TriggerCaptureResponse result =
+      zmk_template_TriggerCaptureResponse_init_zero;
+  result.state = (zmk_template_TriggerState)zmk_template_trigger_get_state();
+  result.pre_events = config.pre_events;
+  result.post_events = config.post_events;
+  result.cycles_per_second = sys_clock_hw_cycles_per_sec();
+  return result;
+}
+
+/**
+ * Handle the ArmTriggerRequest. Responds with the clamped configuration.
+ */
+static int handle_arm_trigger_request(const zmk_template_ArmTriggerRequest *req,
+                                      zmk_template_Response *resp) {
+  struct zmk_template_trigger_config config = {
+      .kind = (enum zmk_template_trigger_kind)req->kind,
+      .position = req->position,
+      .simultaneous_keys = req->simultaneous_keys,
+      .pre_events = req->pre_events,
+      .post_events = req->post_events,
+  };
+
+  zmk_template_trigger_arm(&config);
+
+  resp->which_response_type = zmk_template_Response_trigger_capture_tag;
+  resp->response_type.trigger_capture = trigger_status();
+  return 0;
+}
+
+/**
+ * Encode events of the frozen trigger slice. The slice only changes when the
+ * trigger is re-armed, so both nanopb passes see the same events.
+ */
+static bool encode_trigger_events(pb_ostream_t *stream,
+                                  const pb_field_t *field, void *const *arg) {
+  const struct trigger_slice_range *range = *arg;
+
+  for (size_t i = 0; i < range->count; i++) {
+    struct zmk_template_key_event ev;
+    if (!zmk_template_trigger_slice_event(range->offset + i, &ev)) {
+      return false;
+    }
+
+    zmk_template_KeyEvent event = {
+        .position = ev.position,
+        .pressed = ev.pressed,
+        .timestamp = ev.timestamp,
+    };
+    if (!pb_encode_tag_for_field(stream, field) ||
+        !pb_encode_submessage(stream, zmk_template_KeyEvent_fields, &event)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Handle the GetTriggerCaptureRequest. Events are only returned once the
+ * capture is done.
+ */
+static int handle_get_trigger_capture_request(
+    const zmk_template_GetTriggerCaptureRequest *req,
+    zmk_template_Response *resp) {
+  struct trigger_slice_range *range = &args->trigger;
+  size_t trigger_index = 0;
+  size_t slice = zmk_template_trigger_slice(&trigger_index);
+
+  zmk_template_TriggerCaptureResponse result = trigger_status();
+
+  range->offset = MIN(req->offset, slice);
+  range->count = slice - range->offset;
+  if (req->max_events > 0) {
+    range->count = MIN(range->count, req->max_events);
+  }
+
+  result.slice_events = slice;
+  result.trigger_index = trigger_index;
+  result.offset = range->offset;
+  result.events.funcs.encode = encode_trigger_events;
+  result.events.arg = range;
+
+  resp->which_response_type = zmk_template_Response_trigger_capture_tag;
+  resp->response_type.trigger_capture = result;
+  return 0;
+}
+
+/**
+ * Encode the keys set in the `*arg` bitmap. A key released between the
+ * nanopb passes is still encoded, with a hold time of 0, so both passes
+ * agree.
+ */
+static bool encode_stuck_keys(pb_ostream_t *stream, const pb_field_t *field,
+                              void *const *arg) {
+  const uint8_t *stuck = *arg;
+
+  for (int pos = 0; pos < ZMK_TEMPLATE_KEY_COUNT; pos++) {
+    if (!(stuck[pos / 8] & BIT(pos % 8))) {
+      continue;
+    }
+
+    zmk_template_StuckKey key = zmk_template_StuckKey_init_zero;
+    key.position = pos;
+    zmk_template_stuck_get(pos, &key.held_ms);
+
+    if (!pb_encode_tag_for_field(stream, field) ||
+        !pb_encode_submessage(stream, zmk_template_StuckKey_fields, &key)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Handle the GetStuckKeysRequest with the keys currently flagged as stuck.
+ */
+static int
+handle_get_stuck_keys_request(const zmk_template_GetStuckKeysRequest *req,
+                              zmk_template_Response *resp) {
+  uint8_t *stuck = args->keys;
+
+  memset(stuck, 0, sizeof(args->keys));
+  for (int pos = 0; pos < ZMK_TEMPLATE_KEY_COUNT; pos++) {
+    uint32_t held_ms;
+    if (zmk_template_stuck_get(pos, &held_ms)) {
+      stuck[pos / 8] |= BIT(pos % 8);
+    }
+  }
+
+  zmk_template_StuckKeysResponse result =
+      zmk_template_StuckKeysResponse_init_zero;
+  result.threshold_ms = ZMK_TEMPLATE_STUCK_THRESHOLD_MS;
+  result.total = zmk_template_stuck_total();
+  result.keys.funcs.encode = encode_stuck_keys;
+  result.keys.arg = stuck;
+
+  resp->which_response_type = zmk_template_Response_stuck_keys_tag;
+  resp->response_type.stuck_keys = result;
+  return 0;
+}
+
+/**
+ * Encode the estimates of each key set in the `*arg` bitmap. All fields are
+ * fixed width, so both nanopb passes agree even while keys keep being
+ * released.
+ */
+static bool encode_hold_quantiles(pb_ostream_t *stream,
+                                  const pb_field_t *field, void *const *arg) {
+  const uint8_t *sampled = *arg;
+
+  for (int pos = 0; pos < ZMK_TEMPLATE_KEY_COUNT; pos++) {
+    if (!(sampled[pos / 8] & BIT(pos % 8))) {
+      continue;
+    }
+
+    zmk_template_HoldQuantiles quantiles = zmk_template_HoldQuantiles_init_zero;
+    quantiles.position = pos;
+    quantiles.samples = zmk_template_hold_quantiles_samples(pos);
+    quantiles.p50_us =
+        zmk_template_hold_quantile_us(pos, ZMK_TEMPLATE_HOLD_P50);
+    quantiles.p95_us =
+        zmk_template_hold_quantile_us(pos, ZMK_TEMPLATE_HOLD_P95);
+    quantiles.p99_us =
+        zmk_template_hold_quantile_us(pos, ZMK_TEMPLATE_HOLD_P99);
+
+    if (!pb_encode_tag_for_field(stream, field) ||
+        !pb_encode_submessage(stream, zmk_template_HoldQuantiles_fields,
+                              &quantiles)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Handle the GetHoldQuantilesRequest with the estimates of a page of keys.
+ */
+static int handle_get_hold_quantiles_request(
+    const zmk_template_GetHoldQuantilesRequest *req,
+    zmk_template_Response *resp) {
+  uint8_t *sampled = args->keys;
+
+  if (req->page.offset > ZMK_TEMPLATE_KEY_COUNT) {
+    return -EINVAL;
+  }
+
+  zmk_template_HoldQuantilesResponse result =
+      zmk_template_HoldQuantilesResponse_init_zero;
+
+  // Position, four fixed32 fields and the tags and lengths around them
+  size_t capacity = page_capacity(
+      &req->page,
+      page_overhead(zmk_template_HoldQuantilesResponse_fields, &result),
+      8 + 5 * sizeof(uint32_t));
+  int pos = req->page.offset;
+
+  memset(sampled, 0, sizeof(args->keys));
+  for (size_t listed = 0; pos < ZMK_TEMPLATE_KEY_COUNT && listed < capacity;
+       pos++) {
+    if (zmk_template_hold_quantiles_samples(pos) > 0) {
+      sampled[pos / 8] |= BIT(pos % 8);
+      listed++;
+    }
+  }
+
+  result.keys.funcs.encode = encode_hold_quantiles;
+  result.keys.arg = sampled;
+  result.has_page = true;
+  result.page = page_info(&req->page, req->page.offset, pos);
+
+  resp->which_response_type = zmk_template_Response_hold_quantiles_tag;
+  resp->response_type.hold_quantiles = result;
+  return 0;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_KSCAN_TAP)
+/**
+ * Encode the bounce counts of each key set in the `*arg` bitmap. All fields
+ * are fixed width, so both nanopb passes agree even while keys keep
+ * bouncing.
+ */
+static bool encode_key_bounces(pb_ostream_t *stream, const pb_field_t *field,
+                               void *const *arg) {
+  const uint8_t *bounced = *arg;
+  const struct zmk_template_bounce_stats *stats = zmk_template_bounce_get();
+
+  for (int pos = 0; pos < ZMK_TEMPLATE_KEY_COUNT; pos++) {
+    if (!(bounced[pos / 8] & BIT(pos % 8))) {
+      continue;
+    }
+
+    zmk_template_KeyBounce bounce = zmk_template_KeyBounce_init_zero;
+    bounce.position = pos;
+    bounce.rejected = zmk_template_counter_read(&stats->rejected[pos]);
+    bounce.bursts = zmk_template_counter_read(&stats->bursts[pos]);
+    bounce.max_burst_us = stats->max_burst_us[pos];
+
+    if (!pb_encode_tag_for_field(stream, field) ||
+        !pb_encode_submessage(stream, zmk_template_KeyBounce_fields,
+                              &bounce)) {
+      return false;
+    }
+  }
+  return true;
+}
+#endif
+
+/**
+ * Handle the GetBounceStatsRequest. Fails when no kscan tap is configured.
+ */
+static int
+handle_get_bounce_stats_request(const zmk_template_GetBounceStatsRequest *req,
+                                zmk_template_Response *resp) {
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_KSCAN_TAP)
+  uint8_t *bounced = args->keys;
+  const struct zmk_template_bounce_stats *stats = zmk_template_bounce_get();
+
+  zmk_template_BounceStatsResponse result =
+      zmk_template_BounceStatsResponse_init_zero;
+  BUILD_ASSERT(ZMK_TEMPLATE_BOUNCE_BUCKETS <=
+               ARRAY_SIZE(result.bucket_floor_us));
+
+  for (int b = 0; b < ZMK_TEMPLATE_BOUNCE_BUCKETS; b++) {
+    result.bucket_floor_us[b] =
+        zmk_template_log2_bucket_floor(b, ZMK_TEMPLATE_BOUNCE_MIN_SHIFT);
+    result.press_bursts[b] = stats->press_histogram[b];
+    result.release_bursts[b] = stats->release_histogram[b];
+  }
+  result.bucket_floor_us_count = ZMK_TEMPLATE_BOUNCE_BUCKETS;
+  result.press_bursts_count = ZMK_TEMPLATE_BOUNCE_BUCKETS;
+  result.release_bursts_count = ZMK_TEMPLATE_BOUNCE_BUCKETS;
+
+  if (req->page.offset > ZMK_TEMPLATE_KEY_COUNT) {
+    return -EINVAL;
+  }
+
+  // Position, three fixed32 fields and the tags and lengths around them
+  size_t capacity = page_capacity(
+      &req->page,
+      page_overhead(zmk_template_BounceStatsResponse_fields, &result),
+      8 + 4 * sizeof(uint32_t));
+  int pos = req->page.offset;
+
+  memset(bounced, 0, sizeof(args->keys));
+  for (size_t listed = 0; pos < ZMK_TEMPLATE_KEY_COUNT && listed < capacity;
+       pos++) {
+    if (zmk_template_counter_read(&stats->bursts[pos]) > 0) {
+      bounced[pos / 8] |= BIT(pos % 8);
+      listed++;
+    }
+  }
+  result.keys.funcs.encode = encode_key_bounces;
+  result.keys.arg = bounced;
+  result.has_page = true;
+  result.page = page_info(&req->page, req->page.offset, pos);
+
+  resp->which_response_type = zmk_template_Response_bounce_stats_tag;
+  resp->response_type.bounce_stats = result;
+  return 0;
+#else
+  LOG_WRN("No zmk,kscan-diagnostics-tap configured");
+  return -ENOTSUP;
+#endif
+}
+
+/**
+ * Handle the GetShadowDebounceRequest with the statistics of every shadow
+ * debouncer.
+ */
+static int handle_get_shadow_debounce_request(
+    const zmk_template_GetShadowDebounceRequest *req,
+    zmk_template_Response *resp) {
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_SHADOW_DEBOUNCE)
+  zmk_template_ShadowDebounceResponse result =
+      zmk_template_ShadowDebounceResponse_init_zero;
+  BUILD_ASSERT(ZMK_TEMPLATE_SHADOW_COUNT <= ARRAY_SIZE(result.debouncers));
+
+  result.raw_transitions = zmk_template_shadow_debounce_transitions();
+  for (int d = 0; d < ZMK_TEMPLATE_SHADOW_COUNT; d++) {
+    const struct zmk_template_shadow_timing *timing =
+        zmk_template_shadow_debounce_timing(d);
+    struct zmk_template_shadow_stats stats;
+    zmk_template_ShadowDebouncer *out = &result.debouncers[d];
+
+    zmk_template_shadow_debounce_get(d, &stats);
+    out->kind = (zmk_template_ShadowDebouncerKind)d;
+    out->press_ms = timing->press_ms;
+    out->release_ms = timing->release_ms;
+    out->emitted = stats.emitted;
+    out->suppressed = stats.suppressed;
+    out->delayed = stats.delayed;
+    out->latency_total_us = stats.latency_total_us;
+    out->latency_max_us = stats.latency_max_us;
+    out->chatter = stats.chatter;
+  }
+  result.debouncers_count = ZMK_TEMPLATE_SHADOW_COUNT;
+
+  resp->which_response_type = zmk_template_Response_shadow_debounce_tag;
+  resp->response_type.shadow_debounce = result;
+  return 0;
+#else
+  LOG_WRN("Shadow debouncers are not enabled");
+  return -ENOTSUP;
+#endif
+}
+
+/**
+ * Handle the GetScanTimingRequest, optionally restarting the statistics.
+ */
+static int
+handle_get_scan_timing_request(const zmk_template_GetScanTimingRequest *req,
+                               zmk_template_Response *resp) {
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_SCAN_TIMING)
+  struct zmk_template_scan_timing timing;
+  zmk_template_scan_timing_get(&timing);
+  if (req->reset) {
+    zmk_template_scan_timing_reset();
+  }
+
+  zmk_template_ScanTimingResponse result =
+      zmk_template_ScanTimingResponse_init_zero;
+  BUILD_ASSERT(ZMK_TEMPLATE_SCAN_TIMING_BUCKETS <=
+               ARRAY_SIZE(result.late_histogram));
+
+  result.period_us = ZMK_TEMPLATE_SCAN_TIMING_PERIOD_MS * 1000;
+  result.scans = timing.scans;
+  if (timing.elapsed_ms > 0) {
+    result.scans_per_second =
+        ((uint64_t)timing.scans * 1000 + timing.elapsed_ms / 2) /
+        timing.elapsed_ms;
+  }
+  result.min_interval_us = timing.min_interval_us;
+  result.max_interval_us = timing.max_interval_us;
+  result.mean_interval_us = timing.mean_interval_us;
+  result.interval_variance_us2 = timing.interval_variance_us2;
+  result.max_late_us = timing.max_late_us;
+  for (int b = 0; b < ZMK_TEMPLATE_SCAN_TIMING_BUCKETS; b++) {
+    result.late_bucket_floor_us[b] =
+        zmk_template_log2_bucket_floor(b, ZMK_TEMPLATE_SCAN_TIMING_MIN_SHIFT);
+    result.late_histogram[b] = timing.late_histogram[b];
+  }
+  result.late_bucket_floor_us_count = ZMK_TEMPLATE_SCAN_TIMING_BUCKETS;
+  result.late_histogram_count = ZMK_TEMPLATE_SCAN_TIMING_BUCKETS;
+
+  resp->which_response_type = zmk_template_Response_scan_timing_tag;
+  resp->response_type.scan_timing = result;
+  return 0;
+#else
+  LOG_WRN("Scan timing probe is not enabled");
+  return -ENOTSUP;
+#endif
+}
+
+/**
+ * Handle the GetOverheadRequest with the self-measured cost and mode.
+ */
+static int
+handle_get_overhead_request(const zmk_template_GetOverheadRequest *req,
+                            zmk_template_Response *resp) {
+  struct zmk_template_budget_stats stats;
+  zmk_template_budget_get(&stats);
+
+  zmk_template_OverheadResponse result =
+      zmk_template_OverheadResponse_init_zero;
+
+  result.mode = (zmk_template_OverheadMode)stats.mode;
+  result.overhead_ppm = stats.overhead_ppm;
+  result.budget_ppm = CONFIG_ZMK_TEMPLATE_FEATURE_BUDGET_PPM;
+  result.sample_every = CONFIG_ZMK_TEMPLATE_FEATURE_BUDGET_SAMPLE_EVERY;
+  result.step_downs = stats.step_downs;
+  result.events = stats.events;
+  if (stats.events > 0) {
+    result.mean_event_ns = stats.event_total_ns / stats.events;
+  }
+  result.max_event_ns = stats.event_max_ns;
+
+  resp->which_response_type = zmk_template_Response_overhead_tag;
+  resp->response_type.overhead = result;
+  return 0;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_EVENT_PROFILE)
+/**
+ * Encode the profile of each event type selected by `*arg` from the live
+ * table. The set of types is fixed by the handler and the values are
+ * fixed width, so both nanopb passes agree while events keep being raised.
+ * A requested reset is done once the writing pass is done.
+ */
+static bool encode_event_profiles(pb_ostream_t *stream,
+                                  const pb_field_t *field, void *const *arg) {
+  const struct event_profile_selection *selection = *arg;
+  struct zmk_template_event_profile p;
+
+  for (int i = 0; zmk_template_event_profile_get(i, &p); i++) {
+    if (!(selection->types[i / 8] & BIT(i % 8))) {
+      continue;
+    }
+
+    zmk_template_EventTypeProfile profile =
+        zmk_template_EventTypeProfile_init_zero;
+    strncpy(profile.name, zmk_template_event_profile_name(i),
+            sizeof(profile.name) - 1);
+    profile.dispatches = p.dispatches;
+    profile.total_us = MIN(p.total_ns / 1000, UINT32_MAX);
+    profile.max_us = p.max_ns / 1000;
+    profile.slowest_listener = (uint32_t)(uintptr_t)p.slowest_listener;
+    profile.slowest_us = p.slowest_ns / 1000;
+
+    if (!pb_encode_tag_for_field(stream, field) ||
+        !pb_encode_submessage(stream, zmk_template_EventTypeProfile_fields,
+                              &profile)) {
+      return false;
+    }
+  }
+
+  // Sizing streams have no callback.
+  if (stream->callback != NULL && selection->reset) {
+    zmk_template_event_profile_reset();
+  }
+  return true;
+}
+#endif
+
+/**
+ * Handle the GetEventProfileRequest. Fails when profiling is not enabled.
+ */
+static int
+handle_get_event_profile_request(const zmk_template_GetEventProfileRequest *req,
+                                 zmk_template_Response *resp) {
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_EVENT_PROFILE)
+  struct event_profile_selection *selection = &args->event_profile;
+  struct zmk_template_event_profile p;
+
+  memset(selection->types, 0, sizeof(selection->types));
+  for (int i = 0; zmk_template_event_profile_get(i, &p); i++) {
+    if (p.dispatches > 0) {
+      selection->types[i / 8] |= BIT(i % 8);
+    }
+  }
+  selection->reset = req->reset;
+
+  zmk_template_EventProfileResponse result =
+      zmk_template_EventProfileResponse_init_zero;
+  result.types.funcs.encode = encode_event_profiles;
+  result.types.arg = selection;
+
+  resp->which_response_type = zmk_template_Response_event_profile_tag;
+  resp->response_type.event_profile = result;
+  return 0;
+#else
+  LOG_WRN("Event profiling is not enabled");
+  return -ENOTSUP;
+#endif
+}
+
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_BEHAVIOR_LATENCY)
+/**
+ * Encode each behavior set in the `*arg` bitmap from the live histograms.
+ * The set of behaviors is fixed by the handler and the values are fixed
+ * width, so both nanopb passes agree while keys keep being pressed.
+ */
+static bool encode_behavior_latencies(pb_ostream_t *stream,
+                                      const pb_field_t *field,
+                                      void *const *arg) {
+  const uint8_t *behaviors = *arg;
+
+  for (int i = 0; i < zmk_template_behavior_latency_count(); i++) {
+    if (!(behaviors[i / 8] & BIT(i % 8))) {
+      continue;
+    }
+
+    const struct zmk_template_behavior_latency *entry =
+        zmk_template_behavior_latency_get(i);
+    const struct zmk_template_latency_histogram *histogram = &entry->histogram;
+    zmk_template_BehaviorLatency out = zmk_template_BehaviorLatency_init_zero;
+
+    strncpy(out.name, entry->name, sizeof(out.name) - 1);
+    out.count = histogram->count;
+    out.p50_us = zmk_template_latency_percentile_us(histogram, 50);
+    out.p90_us = zmk_template_latency_percentile_us(histogram, 90);
+    out.p99_us = zmk_template_latency_percentile_us(histogram, 99);
+    out.max_us = histogram->max_us;
+
+    if (!pb_encode_tag_for_field(stream, field) ||
+        !pb_encode_submessage(stream, zmk_template_BehaviorLatency_fields,
+                              &out)) {
+      return false;
+    }
+  }
+  return true;
+}
+#endif
+
+/**
+ * Handle the GetBehaviorLatencyRequest with every behavior pressed so far.
+ */
+static int handle_get_behavior_latency_request(
+    const zmk_template_GetBehaviorLatencyRequest *req,
+    zmk_template_Response *resp) {
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_BEHAVIOR_LATENCY)
+  uint8_t *behaviors = args->behaviors;
+
+  memset(behaviors, 0, sizeof(args->behaviors));
+  for (int i = 0; i < zmk_template_behavior_latency_count(); i++) {
+    const struct zmk_template_behavior_latency *entry =
+        zmk_template_behavior_latency_get(i);
+
+    if (entry->name != NULL && entry->histogram.count > 0) {
+      behaviors[i / 8] |= BIT(i % 8);
+    }
+  }
+
+  zmk_template_BehaviorLatencyResponse result =
+      zmk_template_BehaviorLatencyResponse_init_zero;
+  result.behaviors.funcs.encode = encode_behavior_latencies;
+  result.behaviors.arg = behaviors;
+
+  resp->which_response_type = zmk_template_Response_behavior_latency_tag;
+  resp->response_type.behavior_latency = result;
+  return 0;
+#else
+  LOG_WRN("Behavior latency measurement is not enabled");
+  return -ENOTSUP;
+#endif
+}
+
+/**
+ * Handle the GetHidStatsRequest. Fails when the statistics are not enabled.
+ */
+static int
+handle_get_hid_stats_request(const zmk_template_GetHidStatsRequest *req,
+                             zmk_template_Response *resp) {
+#if IS_ENABLED(CONFIG_ZMK_TEMPLATE_FEATURE_HID_STATS)
+  struct zmk_template_hid_stats stats;
+  zmk_template_hid_stats_get(&stats);
+  if (req->reset) {
+    zmk_template_hid_stats_reset();
+  }
+
+  zmk_template_HidStatsResponse result =
+      zmk_template_HidStatsResponse_init_zero;
+  BUILD_ASSERT(ZMK_TEMPLATE_HID_MERGED_BUCKETS <=
+               ARRAY_SIZE(result.merged_histogram));
+
+  result.reports = stats.reports;
+  result.send_errors = stats.send_errors;
+  result.transitions = stats.transitions;
+  result.reports_per_second = stats.reports_per_second;
+  result.peak_reports_per_second = stats.peak_reports_per_second;
+  for (int b = 0; b < ZMK_TEMPLATE_HID_MERGED_BUCKETS; b++) {
+    result.merged_histogram[b] = stats.merged_histogram[b];
+  }
+  result.merged_histogram_count = ZMK_TEMPLATE_HID_MERGED_BUCKETS;
+  if (stats.reports > 0) {
+    result.transitions_per_report_x100 =
+        (uint64_t)stats.transitions * 100 / stats.reports;
+    result.mean_send_us = stats.send_total_ns / stats.reports / 1000;
+  }
+  result.max_send_us = stats.send_max_ns / 1000;
+
+  resp->which_response_type = zmk_template_Response_hid_stats_tag;
+  resp->response_type.hid_stats = result;
+  return 0;
+#else
+  LOG_WRN("HID report statistics are not enabled");
+  return -ENOTSUP;
+#endif
+}
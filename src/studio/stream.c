@@ -0,0 +1,163 @@
+/**
+ * Template Feature - Event Stream
+ *
+ * While subscribed, a delayable work item drains the capture ring every
+ * interval and sends the events as one notification frame, so a burst of
+ * keypresses costs one notification per interval instead of one per event.
+ * A backlog larger than one frame is flushed in consecutive frames without
+ * waiting for the next interval.
+ *
+ * The stream and ReadEvents are both consumers of the single-consumer capture
+ * ring, so ReadEvents is rejected while the stream is enabled and disabling
+ * the stream waits for an in-flight flush to finish.
+ *
+ * Events are packed into the frame's `events` bytes as a varint time delta
+ * with the press bit in its LSB, followed by a position of one or two bytes,
+ * typically 3-4 bytes per event. They are encoded straight from the drained
+ * events into the nanopb output stream; the sizing pass for the length
+ * prefix walks the same events rather than an intermediate buffer.
+ */
+
+#include <pb_encode.h>
+#include <zephyr/kernel.h>
+#include <zmk/studio/custom.h>
+#include <zmk/template/budget.h>
+#include <zmk/template/capture.h>
+#include <zmk/template/custom.pb.h>
+#include <zmk/template/cycles.h>
+#include <zmk/template/matrix.h>
+#include <zmk/template/stream.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define MAX_FRAME_EVENTS CONFIG_ZMK_TEMPLATE_FEATURE_STREAM_MAX_FRAME_EVENTS
+#define POSITION_BYTES (ZMK_TEMPLATE_KEY_COUNT > 256 ? 2 : 1)
+
+struct frame_batch {
+  const struct zmk_template_key_event *events;
+  size_t count;
+};
+
+static struct zmk_template_stream_config stream_config;
+static uint32_t sequence;
+
+static zmk_template_Notification notification;
+static struct zmk_template_key_event frame_events[MAX_FRAME_EVENTS];
+
+static bool write_packed_events(pb_ostream_t *stream,
+                                const struct frame_batch *batch) {
+  uint32_t base = batch->events[0].timestamp;
+  uint32_t prev_us = 0;
+
+  for (size_t i = 0; i < batch->count; i++) {
+    const struct zmk_template_key_event *ev = &batch->events[i];
+    // Convert the offset from the base rather than each cycle delta so
+    // rounding does not accumulate over the frame.
+    uint32_t us = k_cyc_to_us_floor32(ev->timestamp - base);
+    uint64_t record = ((uint64_t)(us - prev_us) << 1) | ev->pressed;
+    uint8_t position[2] = {ev->position & 0xff, ev->position >> 8};
+
+    if (!pb_encode_varint(stream, record) ||
+        !pb_write(stream, position, POSITION_BYTES)) {
+      return false;
+    }
+    prev_us = us;
+  }
+  return true;
+}
+
+static bool encode_packed_events(pb_ostream_t *stream, const pb_field_t *field,
+                                 void *const *arg) {
+  const struct frame_batch *batch = *arg;
+  pb_ostream_t sizing = PB_OSTREAM_SIZING;
+
+  if (batch->count == 0) {
+    return true;
+  }
+  if (!write_packed_events(&sizing, batch)) {
+    return false;
+  }
+  return pb_encode_tag_for_field(stream, field) &&
+         pb_encode_varint(stream, sizing.bytes_written) &&
+         write_packed_events(stream, batch);
+}
+
+static bool encode_notification(pb_ostream_t *stream, const pb_field_t *field,
+                                void *const *arg) {
+  if (!pb_encode_tag_for_field(stream, field)) {
+    return false;
+  }
+  return pb_encode_submessage(stream, zmk_template_Notification_fields, *arg);
+}
+
+static void send_frame(size_t count, uint32_t dropped, uint32_t sampled_out) {
+  zmk_template_EventFrame frame = zmk_template_EventFrame_init_zero;
+  // The notification is encoded before notify returns, so the batch can live
+  // on the stack.
+  struct frame_batch batch = {.events = frame_events, .count = count};
+
+  frame.sequence = sequence++;
+  frame.dropped = dropped;
+  frame.sampled_out = sampled_out;
+  frame.base_timestamp = count > 0 ? frame_events[0].timestamp : 0;
+  frame.cycles_per_second = sys_clock_hw_cycles_per_sec();
+  frame.event_count = count;
+  frame.position_bytes = POSITION_BYTES;
+  frame.events.funcs.encode = encode_packed_events;
+  frame.events.arg = &batch;
+
+  notification.which_notification_type =
+      zmk_template_Notification_event_frame_tag;
+  notification.notification_type.event_frame = frame;
+
+  pb_callback_t payload = {
+      .funcs.encode = encode_notification,
+      .arg = &notification,
+  };
+  int err = zmk_rpc_custom_subsystem_notify("zmk__template", &payload);
+  if (err < 0) {
+    LOG_WRN("Failed to send event frame %d (%d)", frame.sequence, err);
+  }
+}
+
+static void stream_flush(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(stream_flush_work, stream_flush);
+
+static void stream_flush(struct k_work *work) {
+  zmk_template_cycles_t start = zmk_template_cycles_now();
+  size_t count =
+      zmk_template_capture_read(frame_events, stream_config.max_events);
+  uint32_t dropped = zmk_template_capture_take_dropped();
+  uint32_t sampled_out = zmk_template_capture_take_sampled_out();
+
+  if (count > 0 || dropped > 0 || sampled_out > 0) {
+    send_frame(count, dropped, sampled_out);
+  }
+  zmk_template_budget_account(zmk_template_cycles_since(start), false);
+
+  bool backlog = zmk_template_capture_pending() >= stream_config.max_events;
+  k_work_schedule(&stream_flush_work,
+                  backlog ? K_NO_WAIT : K_MSEC(stream_config.interval_ms));
+}
+
+void zmk_template_stream_configure(struct zmk_template_stream_config *config) {
+  struct k_work_sync sync;
+
+  // Stop any flush before touching the settings it reads.
+  k_work_cancel_delayable_sync(&stream_flush_work, &sync);
+
+  if (config->interval_ms == 0) {
+    config->interval_ms = CONFIG_ZMK_TEMPLATE_FEATURE_STREAM_INTERVAL_MS;
+  }
+  if (config->max_events == 0 || config->max_events > MAX_FRAME_EVENTS) {
+    config->max_events = MAX_FRAME_EVENTS;
+  }
+  stream_config = *config;
+
+  if (config->enabled) {
+    k_work_schedule(&stream_flush_work, K_MSEC(config->interval_ms));
+  }
+}
+
+bool zmk_template_stream_enabled(void) { return stream_config.enabled; }
@@ -0,0 +1,52 @@
+/**
+ * Template Feature - Stuck Key Notification
+ *
+ * Pushes stuck key changes to the host as custom subsystem notifications.
+ */
+
+#include <pb_encode.h>
+#include <zephyr/kernel.h>
+#include <zmk/event_manager.h>
+#include <zmk/studio/custom.h>
+#include <zmk/template/custom.pb.h>
+#include <zmk/template/events/stuck_key_changed.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static bool encode_notification(pb_ostream_t *stream, const pb_field_t *field,
+                                void *const *arg) {
+  if (!pb_encode_tag_for_field(stream, field)) {
+    return false;
+  }
+  return pb_encode_submessage(stream, zmk_template_Notification_fields, *arg);
+}
+
+static int template_stuck_notification_listener(const zmk_event_t *eh) {
+  const struct zmk_template_stuck_key_changed *ev =
+      as_zmk_template_stuck_key_changed(eh);
+  if (ev == NULL) {
+    return ZMK_EV_EVENT_BUBBLE;
+  }
+
+  zmk_template_Notification notification = zmk_template_Notification_init_zero;
+  notification.which_notification_type =
+      zmk_template_Notification_stuck_key_tag;
+  notification.notification_type.stuck_key.position = ev->position;
+  notification.notification_type.stuck_key.stuck = ev->stuck;
+  notification.notification_type.stuck_key.held_ms = ev->held_ms;
+
+  pb_callback_t payload = {
+      .funcs.encode = encode_notification,
+      .arg = &notification,
+  };
+  int err = zmk_rpc_custom_subsystem_notify("zmk__template", &payload);
+  if (err < 0) {
+    LOG_WRN("Failed to send stuck key notification (%d)", err);
+  }
+  return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(template_stuck_notification,
+             template_stuck_notification_listener);
+ZMK_SUBSCRIPTION(template_stuck_notification, zmk_template_stuck_key_changed);
@@ -0,0 +1,147 @@
+/**
+ * Template Feature - Trigger Capture
+ *
+ * Events are written to a power-of-two circular buffer indexed by a running
+ * sequence number. Only the slice [trigger - pre_events, trigger +
+ * post_events] is kept once triggered; the pre-trigger part is whatever the
+ * buffer still holds when the trigger fires.
+ */
+
+#include <zephyr/kernel.h>
+
+#include <zmk/template/trigger.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+BUILD_ASSERT(IS_POWER_OF_TWO(ZMK_TEMPLATE_TRIGGER_BUFFER_SIZE),
+             "Trigger buffer size must be a power of two");
+
+#define BUFFER_MASK (ZMK_TEMPLATE_TRIGGER_BUFFER_SIZE - 1)
+
+static struct k_spinlock lock;
+
+static struct zmk_template_trigger_config config;
+static enum zmk_template_trigger_state state;
+
+static struct zmk_template_key_event buffer[ZMK_TEMPLATE_TRIGGER_BUFFER_SIZE];
+// Sequence numbers of the first event since arming, the triggering event,
+// the next event to write and the end of the post-trigger window
+static uint32_t first;
+static uint32_t trigger;
+static uint32_t next;
+static uint32_t end;
+
+static bool trigger_matches(const struct zmk_template_key_event *ev,
+                            bool chatter, uint32_t pressed_keys) {
+  if (!ev->pressed) {
+    return false;
+  }
+
+  switch (config.kind) {
+  case ZMK_TEMPLATE_TRIGGER_KEY:
+    return ev->position == config.position;
+  case ZMK_TEMPLATE_TRIGGER_CHATTER:
+    return chatter;
+  case ZMK_TEMPLATE_TRIGGER_SIMULTANEOUS:
+    return pressed_keys >= config.simultaneous_keys;
+  default:
+    return false;
+  }
+}
+
+// Must be called with the lock held.
+static void trigger_at(uint32_t seq, uint32_t window_end) {
+  state = ZMK_TEMPLATE_TRIGGER_TRIGGERED;
+  trigger = seq;
+  end = window_end;
+  // Keep at most pre_events, and none from before arming.
+  first = trigger - MIN(config.pre_events, trigger - first);
+
+  if (next == end) {
+    state = ZMK_TEMPLATE_TRIGGER_DONE;
+  }
+}
+
+void zmk_template_trigger_record(const struct zmk_template_key_event *ev,
+                                 bool chatter, uint32_t pressed_keys) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  if (state == ZMK_TEMPLATE_TRIGGER_ARMED ||
+      state == ZMK_TEMPLATE_TRIGGER_TRIGGERED) {
+    buffer[next & BUFFER_MASK] = *ev;
+    next++;
+
+    if (state == ZMK_TEMPLATE_TRIGGER_ARMED &&
+        trigger_matches(ev, chatter, pressed_keys)) {
+      LOG_DBG("position %d triggered capture", ev->position);
+      trigger_at(next - 1, next + config.post_events);
+    } else if (state == ZMK_TEMPLATE_TRIGGER_TRIGGERED && next == end) {
+      state = ZMK_TEMPLATE_TRIGGER_DONE;
+    }
+  }
+
+  k_spin_unlock(&lock, key);
+}
+
+void zmk_template_trigger_fire(enum zmk_template_trigger_kind kind) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  if (state == ZMK_TEMPLATE_TRIGGER_ARMED && config.kind == kind) {
+    LOG_DBG("trigger kind %d fired", kind);
+    trigger_at(next, next + config.post_events);
+  }
+
+  k_spin_unlock(&lock, key);
+}
+
+void zmk_template_trigger_arm(struct zmk_template_trigger_config *new_config) {
+  // The triggering event and the post-trigger window must not overwrite the
+  // pre-trigger events kept.
+  new_config->post_events =
+      MIN(new_config->post_events, ZMK_TEMPLATE_TRIGGER_BUFFER_SIZE - 1);
+  new_config->pre_events =
+      MIN(new_config->pre_events,
+          ZMK_TEMPLATE_TRIGGER_BUFFER_SIZE - 1 - new_config->post_events);
+
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  config = *new_config;
+  first = next;
+  trigger = next;
+  end = next;
+  state = config.kind == ZMK_TEMPLATE_TRIGGER_NONE ? ZMK_TEMPLATE_TRIGGER_IDLE
+                                                   : ZMK_TEMPLATE_TRIGGER_ARMED;
+
+  k_spin_unlock(&lock, key);
+}
+
+enum zmk_template_trigger_state zmk_template_trigger_get_state(void) {
+  return state;
+}
+
+void zmk_template_trigger_get_config(struct zmk_template_trigger_config *out) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  *out = config;
+  k_spin_unlock(&lock, key);
+}
+
+size_t zmk_template_trigger_slice(size_t *trigger_index) {
+  // Once done, the slice only changes when the host re-arms.
+  if (state != ZMK_TEMPLATE_TRIGGER_DONE) {
+    return 0;
+  }
+
+  *trigger_index = trigger - first;
+  return next - first;
+}
+
+bool zmk_template_trigger_slice_event(size_t index,
+                                      struct zmk_template_key_event *out) {
+  if (state != ZMK_TEMPLATE_TRIGGER_DONE || index >= next - first) {
+    return false;
+  }
+
+  *out = buffer[(first + index) & BUFFER_MASK];
+  return true;
+}
@@ -0,0 +1,80 @@
+/**
+ * Template Feature - RPC batch test driver
+ *
+ * Calls the zmk__template subsystem the way ZMK Studio does, so tests can
+ * check the handler without a host connection.
+ */
+
+#include <pb_encode.h>
+#include <string.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zmk/studio/custom.h>
+#include <zmk/template/custom.pb.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+/**
+ * Append `req` to `stream` as a length-delimited field `tag`.
+ */
+static bool encode_nested_request(pb_ostream_t *stream, uint32_t tag,
+                                  const zmk_template_Request *req) {
+  return pb_encode_tag(stream, PB_WT_STRING, tag) &&
+         pb_encode_submessage(stream, zmk_template_Request_fields, req);
+}
+
+/**
+ * Send a batch of two GetKeyCounters pages and encode the call response, so
+ * tests can check that each page keeps its own range.
+ */
+static int rpc_batch_test(void) {
+  static zmk_custom_CallRequest raw;
+  static uint8_t requests[64];
+  static uint8_t out[512];
+  pb_ostream_t items = pb_ostream_from_buffer(requests, sizeof(requests));
+
+  for (uint32_t offset = 0; offset <= 2; offset += 2) {
+    zmk_template_Request req = zmk_template_Request_init_zero;
+    req.which_request_type = zmk_template_Request_get_key_counters_tag;
+    req.request_type.get_key_counters.has_page = true;
+    req.request_type.get_key_counters.page.offset = offset;
+    if (!encode_nested_request(&items, zmk_template_BatchRequest_requests_tag,
+                               &req)) {
+      return -ENOMEM;
+    }
+  }
+
+  pb_ostream_t envelope =
+      pb_ostream_from_buffer(raw.payload.bytes, sizeof(raw.payload.bytes));
+  if (!pb_encode_tag(&envelope, PB_WT_STRING,
+                     zmk_template_Request_batch_tag) ||
+      !pb_encode_string(&envelope, requests, items.bytes_written)) {
+    return -ENOMEM;
+  }
+  raw.payload.size = envelope.bytes_written;
+
+  STRUCT_SECTION_FOREACH(zmk_rpc_custom_subsystem, sub) {
+    if (strcmp(sub->identifier, "zmk__template") != 0) {
+      continue;
+    }
+
+    zmk_custom_CallResponse call = zmk_custom_CallResponse_init_zero;
+    if (!sub->func(&raw, &call.payload)) {
+      LOG_ERR("Handler rejected the batch");
+      return -EIO;
+    }
+
+    pb_ostream_t stream = pb_ostream_from_buffer(out, sizeof(out));
+    if (!pb_encode(&stream, zmk_custom_CallResponse_fields, &call)) {
+      LOG_ERR("Failed to encode: %s", PB_GET_ERROR(&stream));
+      return -EIO;
+    }
+    return 0;
+  }
+
+  LOG_ERR("zmk__template subsystem is not registered");
+  return -ENOENT;
+}
+
+SYS_INIT(rpc_batch_test, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
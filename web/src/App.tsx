@@ -3,7 +3,7 @@
  * Demonstrates custom RPC communication with a ZMK device
  */
 
-import { useContext, useState } from "react";
+import { useContext, useEffect, useRef, useState } from "react";
 import "./App.css";
 import { connect as serial_connect } from "@zmkfirmware/zmk-studio-ts-client/transport/serial";
 import {
@@ -11,7 +11,20 @@ import {
   ZMKCustomSubsystem,
   ZMKAppContext,
 } from "@cormoran/zmk-studio-react-hook";
-import { Request, Response } from "./proto/zmk/template/custom";
+import { callBatchRPC } from "./batch";
+import {
+  applyKeyCounterChanges,
+  keyCounterChangesRequest,
+  type KeyCounterSync,
+} from "./counterSync";
+import { decodeEventFrame } from "./eventFrame";
+import { fetchKeyCounters } from "./paging";
+import {
+  ChatterStatsResponse,
+  Notification,
+  Request,
+  Response,
+} from "./proto/zmk/template/custom";
 
 // Custom subsystem identifier - must match firmware registration
 export const SUBSYSTEM_IDENTIFIER = "zmk__template";
@@ -57,6 +70,9 @@ function App() {
             </section>
 
             <RPCTestSection />
+            <EventStreamSection />
+            <MatrixStateSection />
+            <KeyStatsSection />
           </>
         )}
       />
@@ -170,4 +186,282 @@ export function RPCTestSection() {
   );
 }
 
+// Number of streamed events kept on screen
+const EVENT_STREAM_HISTORY = 50;
+
+interface StreamedEvent {
+  position: number;
+  pressed: boolean;
+  timestampUs: number;
+}
+
+export function EventStreamSection() {
+  const zmkApp = useContext(ZMKAppContext);
+  const [subscribed, setSubscribed] = useState(false);
+  const [events, setEvents] = useState<StreamedEvent[]>([]);
+  const [dropped, setDropped] = useState(0);
+  const [sampledOut, setSampledOut] = useState(0);
+  const [error, setError] = useState<string | null>(null);
+
+  const subsystem = zmkApp?.findSubsystem(SUBSYSTEM_IDENTIFIER);
+
+  // Append pushed frames while subscribed; no polling requests are sent
+  useEffect(() => {
+    if (!zmkApp || !subsystem || !subscribed) return;
+
+    return zmkApp.onNotification({
+      type: "custom",
+      subsystemIndex: subsystem.index,
+      callback: (payload: Uint8Array) => {
+        const frame = Notification.decode(payload).eventFrame;
+        if (!frame) return;
+        const baseUs =
+          frame.cyclesPerSecond > 0
+            ? Math.floor((frame.baseTimestamp * 1e6) / frame.cyclesPerSecond)
+            : 0;
+        const decoded = decodeEventFrame(frame).map((e) => ({
+          position: e.position,
+          pressed: e.pressed,
+          timestampUs: baseUs + e.offsetUs,
+        }));
+        setDropped((d) => d + frame.dropped);
+        setSampledOut((s) => s + frame.sampledOut);
+        setEvents((prev) =>
+          [...prev, ...decoded].slice(-EVENT_STREAM_HISTORY)
+        );
+      },
+    });
+  }, [zmkApp, subsystem, subscribed]);
+
+  if (!zmkApp || !subsystem) return null;
+
+  const setSubscription = async (enable: boolean) => {
+    if (!zmkApp.state.connection) return;
+
+    setError(null);
+    try {
+      const service = new ZMKCustomSubsystem(
+        zmkApp.state.connection,
+        subsystem.index
+      );
+      const request = Request.create({ subscribeEvents: { enable } });
+      const payload = Request.encode(request).finish();
+      const responsePayload = await service.callRPC(payload);
+      if (!responsePayload) return;
+
+      const resp = Response.decode(responsePayload);
+      if (resp.subscribeEvents) {
+        setSubscribed(resp.subscribeEvents.enabled);
+      } else if (resp.error) {
+        setError(resp.error.message);
+      }
+    } catch (error) {
+      console.error("RPC call failed:", error);
+      setError(error instanceof Error ? error.message : "Unknown error");
+    }
+  };
+
+  return (
+    <section className="card">
+      <h2>Event Stream</h2>
+      <p>Key events pushed by the firmware while subscribed:</p>
+
+      <button
+        className="btn btn-primary"
+        onClick={() => setSubscription(!subscribed)}
+      >
+        {subscribed ? "⏹ Unsubscribe" : "▶️ Subscribe"}
+      </button>
+
+      {error && (
+        <div className="error-message">
+          <p>🚨 {error}</p>
+        </div>
+      )}
+
+      <div className="response-box">
+        <h3>Dropped: {dropped}</h3>
+        {sampledOut > 0 && (
+          <p>Left out by the CPU budget: {sampledOut}</p>
+        )}
+        <pre>
+          {events
+            .map(
+              (e) =>
+                `${e.timestampUs}us ${e.pressed ? "press  " : "release"} ${e.position}`
+            )
+            .join("\n")}
+        </pre>
+      </div>
+    </section>
+  );
+}
+
+// Poll period of the live matrix view (100 Hz)
+const MATRIX_POLL_INTERVAL_MS = 10;
+
+// Whether position is set in a packed MatrixStateResponse bitmap
+export function isKeyPressed(bitmap: Uint8Array, position: number): boolean {
+  const byte = bitmap[position >> 3] ?? 0;
+  return (byte & (1 << (position & 7))) !== 0;
+}
+
+export function MatrixStateSection() {
+  const zmkApp = useContext(ZMKAppContext);
+  const [live, setLive] = useState(false);
+  const [keyCount, setKeyCount] = useState(0);
+  const [pressed, setPressed] = useState<Uint8Array>(new Uint8Array());
+  const inFlight = useRef(false);
+
+  const subsystem = zmkApp?.findSubsystem(SUBSYSTEM_IDENTIFIER);
+  const connection = zmkApp?.state.connection;
+
+  useEffect(() => {
+    if (!connection || !subsystem || !live) return;
+
+    const service = new ZMKCustomSubsystem(connection, subsystem.index);
+    const payload = Request.encode(
+      Request.create({ getMatrixState: {} })
+    ).finish();
+
+    // Skip a tick rather than queueing requests behind a slow transport
+    const poll = async () => {
+      if (inFlight.current) return;
+      inFlight.current = true;
+      try {
+        const responsePayload = await service.callRPC(payload);
+        if (!responsePayload) return;
+        const resp = Response.decode(responsePayload);
+        if (resp.matrixState) {
+          setKeyCount(resp.matrixState.keyCount);
+          setPressed(resp.matrixState.pressed);
+        }
+      } catch (error) {
+        console.error("RPC call failed:", error);
+        setLive(false);
+      } finally {
+        inFlight.current = false;
+      }
+    };
+
+    const timer = setInterval(poll, MATRIX_POLL_INTERVAL_MS);
+    return () => clearInterval(timer);
+  }, [connection, subsystem, live]);
+
+  if (!zmkApp || !subsystem) return null;
+
+  return (
+    <section className="card">
+      <h2>Matrix State</h2>
+      <p>Keys currently held down:</p>
+
+      <button className="btn btn-primary" onClick={() => setLive(!live)}>
+        {live ? "⏹ Stop" : "▶️ Start Live View"}
+      </button>
+
+      <div className="matrix-state">
+        {Array.from({ length: keyCount }, (_, position) => (
+          <span
+            key={position}
+            className={
+              isKeyPressed(pressed, position)
+                ? "matrix-key matrix-key-pressed"
+                : "matrix-key"
+            }
+          >
+            {position}
+          </span>
+        ))}
+      </div>
+    </section>
+  );
+}
+
+// Page size of the first key counter dump, small enough for one BLE exchange
+const KEY_COUNTER_PAGE_BYTES = 240;
+
+export function KeyStatsSection() {
+  const zmkApp = useContext(ZMKAppContext);
+  const [sync, setSync] = useState<KeyCounterSync | null>(null);
+  const [chatter, setChatter] = useState<ChatterStatsResponse | null>(null);
+  const [isLoading, setIsLoading] = useState(false);
+  const [error, setError] = useState<string | null>(null);
+
+  const subsystem = zmkApp?.findSubsystem(SUBSYSTEM_IDENTIFIER);
+
+  if (!zmkApp || !subsystem) return null;
+
+  // The first refresh dumps the counters page by page; later ones fetch only
+  // the keys that changed, together with the chatter stats, in one exchange.
+  const refresh = async () => {
+    if (!zmkApp.state.connection) return;
+
+    setIsLoading(true);
+    setError(null);
+    try {
+      const service = new ZMKCustomSubsystem(
+        zmkApp.state.connection,
+        subsystem.index
+      );
+      const current =
+        sync ?? (await fetchKeyCounters(service, KEY_COUNTER_PAGE_BYTES));
+      const [changes, chatterResp] = await callBatchRPC(service, [
+        keyCounterChangesRequest(current),
+        Request.create({ getChatterStats: { page: {} } }),
+      ]);
+
+      setSync(applyKeyCounterChanges(current, changes));
+      if (chatterResp.chatterStats) {
+        setChatter(chatterResp.chatterStats);
+      } else if (chatterResp.error) {
+        setError(chatterResp.error.message);
+      }
+    } catch (error) {
+      console.error("RPC call failed:", error);
+      setError(error instanceof Error ? error.message : "Unknown error");
+    } finally {
+      setIsLoading(false);
+    }
+  };
+
+  return (
+    <section className="card">
+      <h2>Key Statistics</h2>
+      <p>Presses, releases and chatter per key:</p>
+
+      <button
+        className="btn btn-primary"
+        disabled={isLoading}
+        onClick={refresh}
+      >
+        {isLoading ? "⏳ Loading..." : "🔄 Refresh"}
+      </button>
+
+      {error && (
+        <div className="error-message">
+          <p>🚨 {error}</p>
+        </div>
+      )}
+
+      {sync && (
+        <div className="response-box">
+          <h3>Chatter events: {chatter?.total ?? 0}</h3>
+          <pre>
+            {sync.table.presses
+              .map((presses, position) => {
+                const histogram = chatter?.histograms.find(
+                  (h) => h.position === position
+                );
+                const chattered =
+                  histogram?.buckets.reduce((a, b) => a + b, 0) ?? 0;
+                return `${position}: ${presses} presses ${sync.table.releases[position]} releases ${chattered} chatter`;
+              })
+              .join("\n")}
+          </pre>
+        </div>
+      )}
+    </section>
+  );
+}
+
 export default App;
@@ -0,0 +1,33 @@
+/**
+ * Helper for sending several requests in one BatchRequest exchange
+ */
+
+import { Request, Response } from "./proto/zmk/template/custom";
+
+// Anything with the callRPC method of ZMKCustomSubsystem
+export interface RPCService {
+  callRPC(payload: Uint8Array): Promise<Uint8Array | null | undefined>;
+}
+
+// Send requests as one batch and return their responses in the same order
+export async function callBatchRPC(
+  service: RPCService,
+  requests: Request[]
+): Promise<Response[]> {
+  const payload = Request.encode(
+    Request.create({ batch: { requests } })
+  ).finish();
+  const responsePayload = await service.callRPC(payload);
+  if (!responsePayload) {
+    throw new Error("No response from firmware");
+  }
+
+  const resp = Response.decode(responsePayload);
+  if (resp.error) {
+    throw new Error(resp.error.message);
+  }
+  if (!resp.batch || resp.batch.responses.length !== requests.length) {
+    throw new Error("Malformed batch response");
+  }
+  return resp.batch.responses;
+}
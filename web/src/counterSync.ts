@@ -0,0 +1,54 @@
+/**
+ * Incremental key counter sync using GetKeyCounterChanges
+ */
+
+import { Request, Response } from "./proto/zmk/template/custom";
+import type { RPCService } from "./batch";
+import type { KeyCounterTable } from "./paging";
+
+export interface KeyCounterSync {
+  table: KeyCounterTable;
+  // Generation to ask changes after; 0 before the first sync
+  generation: number;
+}
+
+// Request for the keys changed since the last sync, e.g. to add to a batch
+export function keyCounterChangesRequest(sync: KeyCounterSync): Request {
+  return Request.create({
+    getKeyCounterChanges: { sinceGeneration: sync.generation },
+  });
+}
+
+// Patch the keys of a GetKeyCounterChanges response into the table
+export function applyKeyCounterChanges(
+  sync: KeyCounterSync,
+  resp: Response
+): KeyCounterSync {
+  if (resp.error) throw new Error(resp.error.message);
+  if (!resp.keyCounterChanges) {
+    throw new Error("Malformed key counter changes response");
+  }
+
+  const presses = [...sync.table.presses];
+  const releases = [...sync.table.releases];
+  for (const change of resp.keyCounterChanges.changes) {
+    presses[change.position] = change.presses;
+    releases[change.position] = change.releases;
+  }
+  return {
+    table: { presses, releases },
+    generation: resp.keyCounterChanges.generation,
+  };
+}
+
+// Fetch the keys changed since the last sync and patch them into the table
+export async function syncKeyCounters(
+  service: RPCService,
+  sync: KeyCounterSync
+): Promise<KeyCounterSync> {
+  const payload = Request.encode(keyCounterChangesRequest(sync)).finish();
+  const responsePayload = await service.callRPC(payload);
+  if (!responsePayload) throw new Error("No response from firmware");
+
+  return applyKeyCounterChanges(sync, Response.decode(responsePayload));
+}
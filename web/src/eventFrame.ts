@@ -0,0 +1,46 @@
+/**
+ * Decoder for the packed events of an EventFrame notification
+ */
+
+import { EventFrame } from "./proto/zmk/template/custom";
+
+export interface StreamedKeyEvent {
+  position: number;
+  pressed: boolean;
+  // Microseconds since the frame's base_timestamp
+  offsetUs: number;
+}
+
+// Unpack the varint delta + position records of a frame
+export function decodeEventFrame(frame: EventFrame): StreamedKeyEvent[] {
+  const data = frame.events;
+  const events: StreamedKeyEvent[] = [];
+  let offset = 0;
+  let offsetUs = 0;
+
+  while (offset < data.length && events.length < frame.eventCount) {
+    let record = 0;
+    let scale = 1;
+    let byte: number;
+    do {
+      if (offset >= data.length) throw new Error("Truncated event frame");
+      byte = data[offset++];
+      // Multiply instead of shifting so deltas above 2^31 stay exact
+      record += (byte & 0x7f) * scale;
+      scale *= 128;
+    } while (byte & 0x80);
+
+    if (offset + frame.positionBytes > data.length) {
+      throw new Error("Truncated event frame");
+    }
+    let position = 0;
+    for (let i = 0; i < frame.positionBytes; i++) {
+      position |= data[offset++] << (8 * i);
+    }
+
+    offsetUs += Math.floor(record / 2);
+    events.push({ position, pressed: record % 2 === 1, offsetUs });
+  }
+
+  return events;
+}
@@ -0,0 +1,53 @@
+/**
+ * Helper for dumping paged tables (key counters) in bounded pieces
+ */
+
+import { Request, Response } from "./proto/zmk/template/custom";
+import type { RPCService } from "./batch";
+import { syncKeyCounters, type KeyCounterSync } from "./counterSync";
+
+export interface KeyCounterTable {
+  presses: number[];
+  releases: number[];
+}
+
+// Fetch all key counters page by page. Keys keep counting during the dump, so
+// when the firmware reports that the counters changed between pages, the keys
+// changed since the first page are patched in afterwards instead of
+// restarting. The result can be kept up to date with syncKeyCounters.
+export async function fetchKeyCounters(
+  service: RPCService,
+  maxBytes: number
+): Promise<KeyCounterSync> {
+  const table: KeyCounterTable = { presses: [], releases: [] };
+  let offset = 0;
+  let generation = 0;
+  let consistent = true;
+
+  for (;;) {
+    const payload = Request.encode(
+      Request.create({
+        getKeyCounters: { page: { offset, maxBytes, generation } },
+      })
+    ).finish();
+    const responsePayload = await service.callRPC(payload);
+    if (!responsePayload) throw new Error("No response from firmware");
+
+    const resp = Response.decode(responsePayload);
+    if (resp.error) throw new Error(resp.error.message);
+    const page = resp.keyCounters?.page;
+    if (!resp.keyCounters || !page) {
+      throw new Error("Malformed key counters response");
+    }
+
+    table.presses.push(...resp.keyCounters.presses);
+    table.releases.push(...resp.keyCounters.releases);
+    generation = page.generation;
+    consistent &&= page.consistent;
+    if (!page.more) break;
+    offset = page.nextOffset;
+  }
+
+  const sync = { table, generation };
+  return consistent ? sync : syncKeyCounters(service, sync);
+}
@@ -0,0 +1,46 @@
+/**
+ * Tests for EventStreamSection component
+ */
+
+import { render, screen } from "@testing-library/react";
+import {
+  createConnectedMockZMKApp,
+  ZMKAppProvider,
+} from "@cormoran/zmk-studio-react-hook/testing";
+import { EventStreamSection, SUBSYSTEM_IDENTIFIER } from "../src/App";
+
+describe("EventStreamSection Component", () => {
+  it("should render subscribe control when subsystem is found", () => {
+    const mockZMKApp = createConnectedMockZMKApp({
+      subsystems: [SUBSYSTEM_IDENTIFIER],
+    });
+
+    render(
+      <ZMKAppProvider value={mockZMKApp}>
+        <EventStreamSection />
+      </ZMKAppProvider>
+    );
+
+    expect(screen.getByText(/Event Stream/i)).toBeInTheDocument();
+    expect(screen.getByText(/Subscribe/i)).toBeInTheDocument();
+    expect(screen.getByText(/Dropped: 0/i)).toBeInTheDocument();
+  });
+
+  it("should not render when subsystem is not found", () => {
+    const mockZMKApp = createConnectedMockZMKApp({ subsystems: [] });
+
+    const { container } = render(
+      <ZMKAppProvider value={mockZMKApp}>
+        <EventStreamSection />
+      </ZMKAppProvider>
+    );
+
+    expect(container.firstChild).toBeNull();
+  });
+
+  it("should not render when ZMKAppContext is not provided", () => {
+    const { container } = render(<EventStreamSection />);
+
+    expect(container.firstChild).toBeNull();
+  });
+});
@@ -0,0 +1,33 @@
+/**
+ * Tests for KeyStatsSection component
+ */
+
+import { render, screen } from "@testing-library/react";
+import {
+  createConnectedMockZMKApp,
+  ZMKAppProvider,
+} from "@cormoran/zmk-studio-react-hook/testing";
+import { KeyStatsSection, SUBSYSTEM_IDENTIFIER } from "../src/App";
+
+describe("KeyStatsSection Component", () => {
+  it("should render refresh control when subsystem is found", () => {
+    const mockZMKApp = createConnectedMockZMKApp({
+      subsystems: [SUBSYSTEM_IDENTIFIER],
+    });
+
+    render(
+      <ZMKAppProvider value={mockZMKApp}>
+        <KeyStatsSection />
+      </ZMKAppProvider>
+    );
+
+    expect(screen.getByText(/Key Statistics/i)).toBeInTheDocument();
+    expect(screen.getByText(/Refresh/i)).toBeInTheDocument();
+  });
+
+  it("should not render when ZMKAppContext is not provided", () => {
+    const { container } = render(<KeyStatsSection />);
+
+    expect(container.firstChild).toBeNull();
+  });
+});
@@ -0,0 +1,50 @@
+/**
+ * Tests for MatrixStateSection component
+ */
+
+import { render, screen } from "@testing-library/react";
+import {
+  createConnectedMockZMKApp,
+  ZMKAppProvider,
+} from "@cormoran/zmk-studio-react-hook/testing";
+import {
+  isKeyPressed,
+  MatrixStateSection,
+  SUBSYSTEM_IDENTIFIER,
+} from "../src/App";
+
+describe("isKeyPressed", () => {
+  it("should read bits least significant first", () => {
+    const bitmap = new Uint8Array([0b00000101, 0b10000000]);
+
+    expect(isKeyPressed(bitmap, 0)).toBe(true);
+    expect(isKeyPressed(bitmap, 1)).toBe(false);
+    expect(isKeyPressed(bitmap, 2)).toBe(true);
+    expect(isKeyPressed(bitmap, 15)).toBe(true);
+    // Trailing positions beyond the bitmap are released
+    expect(isKeyPressed(bitmap, 16)).toBe(false);
+  });
+});
+
+describe("MatrixStateSection Component", () => {
+  it("should render live view control when subsystem is found", () => {
+    const mockZMKApp = createConnectedMockZMKApp({
+      subsystems: [SUBSYSTEM_IDENTIFIER],
+    });
+
+    render(
+      <ZMKAppProvider value={mockZMKApp}>
+        <MatrixStateSection />
+      </ZMKAppProvider>
+    );
+
+    expect(screen.getByText(/Matrix State/i)).toBeInTheDocument();
+    expect(screen.getByText(/Start Live View/i)).toBeInTheDocument();
+  });
+
+  it("should not render when ZMKAppContext is not provided", () => {
+    const { container } = render(<MatrixStateSection />);
+
+    expect(container.firstChild).toBeNull();
+  });
+});
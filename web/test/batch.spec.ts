@@ -0,0 +1,49 @@
+/**
+ * Tests for the batch RPC helper
+ */
+
+import { callBatchRPC } from "../src/batch";
+import { Request, Response } from "../src/proto/zmk/template/custom";
+
+describe("callBatchRPC", () => {
+  it("should send one batch and return responses in order", async () => {
+    const service = {
+      callRPC: jest.fn(async (payload: Uint8Array) => {
+        const req = Request.decode(payload);
+        expect(req.batch?.requests).toHaveLength(2);
+        return Response.encode(
+          Response.create({
+            batch: {
+              responses: [
+                { keyCounters: { keyCount: 4 } },
+                { matrixState: { keyCount: 4 } },
+              ],
+            },
+          })
+        ).finish();
+      }),
+    };
+
+    const responses = await callBatchRPC(service, [
+      Request.create({ getKeyCounters: {} }),
+      Request.create({ getMatrixState: {} }),
+    ]);
+
+    expect(service.callRPC).toHaveBeenCalledTimes(1);
+    expect(responses[0].keyCounters?.keyCount).toBe(4);
+    expect(responses[1].matrixState?.keyCount).toBe(4);
+  });
+
+  it("should throw on an error response", async () => {
+    const service = {
+      callRPC: async () =>
+        Response.encode(
+          Response.create({ error: { message: "Failed to process batch" } })
+        ).finish(),
+    };
+
+    await expect(
+      callBatchRPC(service, [Request.create({ getMatrixState: {} })])
+    ).rejects.toThrow(/Failed to process batch/);
+  });
+});
@@ -0,0 +1,34 @@
+/**
+ * Tests for the incremental key counter sync
+ */
+
+import { syncKeyCounters } from "../src/counterSync";
+import { Request, Response } from "../src/proto/zmk/template/custom";
+
+describe("syncKeyCounters", () => {
+  it("should patch changed keys and keep the new generation", async () => {
+    const service = {
+      callRPC: jest.fn(async (payload: Uint8Array) => {
+        const req = Request.decode(payload).getKeyCounterChanges!;
+        expect(req.sinceGeneration).toBe(10);
+        return Response.encode(
+          Response.create({
+            keyCounterChanges: {
+              generation: 14,
+              changes: [{ position: 2, presses: 5, releases: 4 }],
+            },
+          })
+        ).finish();
+      }),
+    };
+
+    const sync = await syncKeyCounters(service, {
+      table: { presses: [1, 1, 1], releases: [1, 1, 1] },
+      generation: 10,
+    });
+
+    expect(sync.generation).toBe(14);
+    expect(sync.table.presses).toEqual([1, 1, 5]);
+    expect(sync.table.releases).toEqual([1, 1, 4]);
+  });
+});
@@ -0,0 +1,48 @@
+/**
+ * Tests for the packed EventFrame decoder
+ */
+
+import { decodeEventFrame } from "../src/eventFrame";
+import { EventFrame } from "../src/proto/zmk/template/custom";
+
+describe("decodeEventFrame", () => {
+  it("should decode one byte positions and varint deltas", () => {
+    const frame = EventFrame.create({
+      eventCount: 3,
+      positionBytes: 1,
+      events: new Uint8Array([
+        0x01, 0x05, // +0 us, pressed, position 5
+        0xd0, 0x0f, 0x05, // +1000 us, released, position 5
+        0x03, 0x2a, // +1 us, pressed, position 42
+      ]),
+    });
+
+    expect(decodeEventFrame(frame)).toEqual([
+      { position: 5, pressed: true, offsetUs: 0 },
+      { position: 5, pressed: false, offsetUs: 1000 },
+      { position: 42, pressed: true, offsetUs: 1001 },
+    ]);
+  });
+
+  it("should decode two byte little endian positions", () => {
+    const frame = EventFrame.create({
+      eventCount: 1,
+      positionBytes: 2,
+      events: new Uint8Array([0x01, 0x2c, 0x01]),
+    });
+
+    expect(decodeEventFrame(frame)).toEqual([
+      { position: 300, pressed: true, offsetUs: 0 },
+    ]);
+  });
+
+  it("should reject truncated frames", () => {
+    const frame = EventFrame.create({
+      eventCount: 1,
+      positionBytes: 2,
+      events: new Uint8Array([0x01, 0x2c]),
+    });
+
+    expect(() => decodeEventFrame(frame)).toThrow(/Truncated/);
+  });
+});
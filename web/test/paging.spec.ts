@@ -0,0 +1,77 @@
+/**
+ * Tests for the paged key counter dump
+ */
+
+import { fetchKeyCounters } from "../src/paging";
+import { Request, Response } from "../src/proto/zmk/template/custom";
+
+// Fake firmware paging a 5-key table two keys at a time
+function fakeService(generations: number[]) {
+  const presses = [1, 2, 3, 4, 5];
+  let call = 0;
+
+  return {
+    callRPC: jest.fn(async (payload: Uint8Array) => {
+      const req = Request.decode(payload);
+      const current = generations[Math.min(call++, generations.length - 1)];
+      if (req.getKeyCounterChanges) {
+        // Keys 0 and 4 were pressed again after the first page
+        return Response.encode(
+          Response.create({
+            keyCounterChanges: {
+              generation: current,
+              changes: [
+                { position: 0, presses: 10, releases: 10 },
+                { position: 4, presses: 50, releases: 50 },
+              ],
+            },
+          })
+        ).finish();
+      }
+      const page = req.getKeyCounters!.page!;
+      const next = Math.min(page.offset + 2, presses.length);
+      return Response.encode(
+        Response.create({
+          keyCounters: {
+            keyCount: presses.length,
+            presses: presses.slice(page.offset, next),
+            releases: presses.slice(page.offset, next),
+            page: {
+              offset: page.offset,
+              nextOffset: next,
+              more: next < presses.length,
+              generation: page.generation || current,
+              consistent:
+                page.generation === 0 || page.generation === current,
+            },
+          },
+        })
+      ).finish();
+    }),
+  };
+}
+
+describe("fetchKeyCounters", () => {
+  it("should join all pages", async () => {
+    const service = fakeService([7]);
+
+    const { table, generation } = await fetchKeyCounters(service, 48);
+
+    expect(table.presses).toEqual([1, 2, 3, 4, 5]);
+    expect(generation).toBe(7);
+    expect(service.callRPC).toHaveBeenCalledTimes(3);
+  });
+
+  it("should patch keys that change between pages", async () => {
+    // Generation moves on during the second page of the dump
+    const service = fakeService([7, 8, 9, 9]);
+
+    const { table, generation } = await fetchKeyCounters(service, 48);
+
+    expect(table.presses).toEqual([10, 2, 3, 4, 50]);
+    expect(generation).toBe(9);
+    expect(service.callRPC).toHaveBeenCalledTimes(4);
+    const last = Request.decode(service.callRPC.mock.calls[3][0]);
+    expect(last.getKeyCounterChanges?.sinceGeneration).toBe(7);
+  });
+});